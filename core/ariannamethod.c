@@ -35,6 +35,27 @@
 #include <dlfcn.h>   // for dlopen, dlsym, dlclose (Blood compiler)
 #endif
 
+// Field thread pool (vocabulary sharding). Define AM_THREADS_DISABLED to drop
+// the pthread dependency; am_field_threads() then always reports 1.
+#if !defined(AM_THREADS_DISABLED) && !defined(__EMSCRIPTEN__)
+  #define AM_HAVE_THREADS
+  #include <pthread.h>
+  #include <sched.h>
+  #include <stdatomic.h>
+#endif
+
+// SIMD logit kernels: AVX2/AVX-512 picked by cpuid, NEON on aarch64.
+// Define AM_SIMD_DISABLED for a scalar-only build.
+#if !defined(AM_SIMD_DISABLED) && !defined(__EMSCRIPTEN__) && defined(__GNUC__)
+  #if defined(__x86_64__) || defined(__i386__)
+    #define AM_HAVE_X86
+    #include <immintrin.h>
+  #elif defined(__aarch64__)
+    #define AM_HAVE_NEON
+    #include <arm_neon.h>
+  #endif
+#endif
+
 // Platform detection for Blood compiler
 #ifdef __APPLE__
   #define AM_BLOOD_EXT ".dylib"
@@ -381,8 +402,13 @@ static void update_effective_temp(void) {
 // PUBLIC API — the breath
 // ═══════════════════════════════════════════════════════════════════════════════
 
+static void last_row_set(const void* row, int n, int fmt, int has_max, float mx);  // forward
+static void rng_forget(void);      // forward
+
 void am_init(void) {
   memset(&G, 0, sizeof(G));
+  last_row_set(NULL, 0, 0, 0, 0.0f);
+  rng_forget();
 
   // prophecy physics defaults
   G.prophecy = 7;
@@ -512,6 +538,8 @@ void am_init(void) {
 
   // blood compiler
   am_blood_init();
+
+  am_field_plan_build();
 }
 
 // enable/disable packs
@@ -537,6 +565,7 @@ void am_reset_field(void) {
   G.temporal_debt = 0.0f;
   G.pending_jump = 0;
   G.chirality_accum = 0;
+  am_field_plan_build();
 }
 
 void am_reset_debt(void) {
@@ -574,6 +603,60 @@ static void set_error(AML_ExecCtx* ctx, const char* msg) {
     set_error_at(ctx, 0, msg);
 }
 
+// Perfect hash over a static name table, case-insensitive. Every entry starts
+// with its const char* name. The seed is searched once until each name owns a
+// slot, so a lookup is one hash, one probe and one compare; if no seed in the
+// budget is collision-free, linear probing still finds every name.
+#define AML_PHASH_SLOTS 512
+
+typedef struct {
+    uint32_t seed;
+    int16_t  slot[AML_PHASH_SLOTS];   // table index, -1 = empty
+} AML_PHash;
+
+#define PHASH_NAME(table, stride, i) \
+    (*(const char* const*)((const char*)(table) + (size_t)(i) * (stride)))
+
+static uint32_t aml_name_hash(const char* s, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        h = (h ^ (c >= 'a' && c <= 'z' ? c - 32u : c)) * 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    return h & (AML_PHASH_SLOTS - 1);
+}
+
+static int aml_phash_find(const AML_PHash* ph, const void* table, size_t stride,
+                          const char* name) {
+    uint32_t h = aml_name_hash(name, ph->seed);
+    for (int k = ph->slot[h]; k >= 0; k = ph->slot[h]) {
+        if (strcasecmp(PHASH_NAME(table, stride, k), name) == 0) return k;
+        h = (h + 1) & (AML_PHASH_SLOTS - 1);
+    }
+    return -1;
+}
+
+// Duplicate names keep the first entry, as a linear scan would
+static void aml_phash_build(AML_PHash* ph, const void* table, size_t stride, int n) {
+    for (uint32_t seed = 0;; seed++) {
+        int perfect = 1;
+        ph->seed = seed;
+        memset(ph->slot, -1, sizeof(ph->slot));
+        for (int i = 0; i < n; i++) {
+            const char* name = PHASH_NAME(table, stride, i);
+            if (aml_phash_find(ph, table, stride, name) >= 0) continue;
+            uint32_t h = aml_name_hash(name, seed);
+            if (ph->slot[h] >= 0) perfect = 0;
+            while (ph->slot[h] >= 0) h = (h + 1) & (AML_PHASH_SLOTS - 1);
+            ph->slot[h] = (int16_t)i;
+        }
+        if (perfect || seed == 4095) return;
+    }
+}
+
 // AM_State field map — read state fields in expressions
 // offsetof is standard but we use manual offsets for clarity
 #define FIELD_F(name, field) { name, (int)offsetof(AM_State, field), 0 }
@@ -628,8 +711,7 @@ static const AML_FieldMap g_field_map[] = {
     FIELD_F("resonance",         resonance),
     FIELD_F("emergence",         emergence),
     FIELD_F("destiny_bias",      destiny_bias),
-    // dark matter
-    FIELD_F("dark_gravity",      dark_gravity),
+    // dark matter (dark_gravity is listed with the laws above)
     FIELD_I("n_scars",           n_scars),
     // 4.C seasons
     FIELD_I("season",            season),
@@ -645,60 +727,57 @@ static const AML_FieldMap g_field_map[] = {
     FIELD_F("janus_blend",       janus_blend),
     FIELD_F("gamma_drift",       gamma_drift),
     FIELD_I("n_gamma",           n_gamma),
+    // Token accounting
+    FIELD_F("last_debt",         last_debt),
+    FIELD_I("tokens_committed",  tokens_committed),
+    FIELD_I("wormhole_tokens",   wormhole_tokens),
     { NULL, 0, 0 }
 };
 
+#define AML_FIELD_COUNT ((int)(sizeof(g_field_map) / sizeof(g_field_map[0])) - 1)
+
+static AML_PHash g_field_hash;
+
+__attribute__((constructor))
+static void field_hash_build(void) {
+    aml_phash_build(&g_field_hash, g_field_map, sizeof(AML_FieldMap), AML_FIELD_COUNT);
+}
+
+// Field id = index into g_field_map, -1 if unknown (case-insensitive)
+static int field_find(const char* name) {
+    return aml_phash_find(&g_field_hash, g_field_map, sizeof(AML_FieldMap), name);
+}
+
+static float field_get(int id) {
+    const AML_FieldMap* f = &g_field_map[id];
+    const char* base = (const char*)&G;
+    if (f->is_int) return (float)(*(const int*)(base + f->offset));
+    return *(const float*)(base + f->offset);
+}
+
 // Read a field from AM_State by name (case-insensitive), returns 1 if found
 static int read_field(const char* name, float* out) {
-    for (const AML_FieldMap* f = g_field_map; f->name; f++) {
-        if (strcasecmp(name, f->name) == 0) {
-            char* base = (char*)&G;
-            if (f->is_int) {
-                *out = (float)(*(int*)(base + f->offset));
-            } else {
-                *out = *(float*)(base + f->offset);
-            }
-            return 1;
-        }
-    }
-    return 0;
+    int id = field_find(name);
+    if (id < 0) return 0;
+    *out = field_get(id);
+    return 1;
 }
 
-// Symbol table operations
-static float* symtab_get(AML_Symtab* tab, const char* name) {
-    for (int i = 0; i < tab->count; i++) {
-        if (strcmp(tab->vars[i].name, name) == 0)
-            return &tab->vars[i].value;
-    }
-    return NULL;
+int am_field_id(const char* name) {
+    return name ? field_find(name) : -1;
 }
 
-static int symtab_set(AML_Symtab* tab, const char* name, float value) {
-    for (int i = 0; i < tab->count; i++) {
-        if (strcmp(tab->vars[i].name, name) == 0) {
-            tab->vars[i].value = value;
-            return 0;
-        }
-    }
-    if (tab->count >= AML_MAX_VARS) return 1;
-    snprintf(tab->vars[tab->count].name, AML_MAX_NAME, "%s", name);
-    tab->vars[tab->count].value = value;
-    tab->count++;
-    return 0;
+float am_get_field_by_id(int id) {
+    if (id < 0 || id >= AML_FIELD_COUNT) return 0.0f;
+    return field_get(id);
 }
 
+// Resolve script variable: current frame → globals (see COMPILED SCRIPTS)
+static int resolve_sym(AML_ExecCtx* ctx, const char* name, float* out);
+
 // Resolve variable: locals → globals → field map
 static int resolve_var(AML_ExecCtx* ctx, const char* name, float* out) {
-    // local scope first
-    if (ctx->call_depth > 0) {
-        float* v = symtab_get(&ctx->locals[ctx->call_depth - 1], name);
-        if (v) { *out = *v; return 1; }
-    }
-    // global scope
-    float* v = symtab_get(&ctx->globals, name);
-    if (v) { *out = *v; return 1; }
-    // AM_State field
-    return read_field(name, out);
+    return resolve_sym(ctx, name, out) || read_field(name, out);
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════
@@ -933,6 +1012,7 @@ static float aml_eval_arg(AML_ExecCtx* ctx, const char* arg) {
 static float ctx_float(AML_ExecCtx* ctx, const char* arg) {
     if (!arg || !*arg) return 0.0f;
     if (!ctx) return safe_atof(arg);
+    if (arg == ctx->arg_text) return ctx->arg_value;   // compiled argument
     return aml_eval_arg(ctx, arg);
 }
 static int ctx_int(AML_ExecCtx* ctx, const char* arg) {
@@ -1106,72 +1186,173 @@ int am_blood_compile_emotion(const char* name, float valence, float arousal);
 void am_blood_unload(int module_idx);
 
 // ═══════════════════════════════════════════════════════════════════════════════
-// LEVEL 0 DISPATCH — the original flat command parser, extracted
+// LEVEL 0 DISPATCH — command table, perfect hash, switch on command id
 // ═══════════════════════════════════════════════════════════════════════════════
 
-// Execute a single Level 0 command (CMD + ARG already split, CMD already upcased)
+// Command table: name → AM_CMD_* id. Hashed at load time (g_cmd_hash), so a
+// name costs one hash and one compare however far down the list it sits.
+#define AML_CMD_NS   1   // CODES/RIC command, also reachable as CODES.<cmd> / RIC.<cmd>
+#define AML_CMD_EXPR 2   // whole argument is one number/expression (ctx_float/ctx_int)
+
+typedef struct {
+    const char* name;
+    int id;
+    int flags;
+} AML_CmdDef;
+
+static const AML_CmdDef g_cmds[] = {
+    { "PROPHECY",              AM_CMD_PROPHECY,            AML_CMD_EXPR },
+    { "DESTINY",               AM_CMD_DESTINY,             AML_CMD_EXPR },
+    { "WORMHOLE",              AM_CMD_WORMHOLE,            AML_CMD_EXPR },
+    { "CALENDAR_DRIFT",        AM_CMD_CALENDAR_DRIFT,      AML_CMD_EXPR },
+    { "ATTEND_FOCUS",          AM_CMD_ATTEND_FOCUS,        AML_CMD_EXPR },
+    { "ATTEND_SPREAD",         AM_CMD_ATTEND_SPREAD,       AML_CMD_EXPR },
+    { "TUNNEL_THRESHOLD",      AM_CMD_TUNNEL_THRESHOLD,    AML_CMD_EXPR },
+    { "TUNNEL_CHANCE",         AM_CMD_TUNNEL_CHANCE,       AML_CMD_EXPR },
+    { "TUNNEL_SKIP_MAX",       AM_CMD_TUNNEL_SKIP_MAX,     AML_CMD_EXPR },
+    { "PAIN",                  AM_CMD_PAIN,                AML_CMD_EXPR },
+    { "TENSION",               AM_CMD_TENSION,             AML_CMD_EXPR },
+    { "DISSONANCE",            AM_CMD_DISSONANCE,          AML_CMD_EXPR },
+    { "PROPHECY_DEBT",         AM_CMD_PROPHECY_DEBT,       AML_CMD_EXPR },
+    { "PROPHECY_DEBT_DECAY",   AM_CMD_PROPHECY_DEBT_DECAY, AML_CMD_EXPR },
+    { "JUMP",                  AM_CMD_JUMP,                0 },
+    { "VELOCITY",              AM_CMD_VELOCITY,            0 },
+    { "BASE_TEMP",             AM_CMD_BASE_TEMP,           AML_CMD_EXPR },
+    { "RESET_FIELD",           AM_CMD_RESET_FIELD,         0 },
+    { "RESET_DEBT",            AM_CMD_RESET_DEBT,          0 },
+    { "LAW",                   AM_CMD_LAW,                 0 },
+    { "MODE",                  AM_CMD_MODE,                0 },
+    { "IMPORT",                AM_CMD_MODE,                0 },
+    { "DISABLE",               AM_CMD_DISABLE,             0 },
+    { "CHORDLOCK",             AM_CMD_CHORDLOCK,           AML_CMD_NS },
+    { "TEMPOLOCK",             AM_CMD_TEMPOLOCK,           AML_CMD_NS },
+    { "CHIRALITY",             AM_CMD_CHIRALITY,           AML_CMD_NS },
+    { "TEMPO",                 AM_CMD_TEMPO,               AML_CMD_NS | AML_CMD_EXPR },
+    { "PAS_THRESHOLD",         AM_CMD_PAS_THRESHOLD,       AML_CMD_NS | AML_CMD_EXPR },
+    { "ANCHOR",                AM_CMD_ANCHOR,              0 },
+    { "GRAVITY",               AM_CMD_GRAVITY,             0 },
+    { "ANTIDOTE",              AM_CMD_ANTIDOTE,            0 },
+    { "SCAR",                  AM_CMD_SCAR,                0 },
+    { "SCHUMANN",              AM_CMD_SCHUMANN,            AML_CMD_EXPR },
+    { "SCHUMANN_MODULATION",   AM_CMD_SCHUMANN_MODULATION, AML_CMD_EXPR },
+    { "COSMIC_COHERENCE",      AM_CMD_COSMIC_COHERENCE,    AML_CMD_EXPR },
+    { "LORA_ALPHA",            AM_CMD_LORA_ALPHA,          AML_CMD_EXPR },
+    { "NOTORCH_LR",            AM_CMD_NOTORCH_LR,          AML_CMD_EXPR },
+    { "NOTORCH_DECAY",         AM_CMD_NOTORCH_DECAY,       AML_CMD_EXPR },
+    { "RESONANCE_BOOST",       AM_CMD_RESONANCE_BOOST,     0 },
+    { "SEASON",                AM_CMD_SEASON,              0 },
+    { "SEASON_INTENSITY",      AM_CMD_SEASON_INTENSITY,    AML_CMD_EXPR },
+    { "GAMMA",                 AM_CMD_GAMMA,               0 },
+    { "GAMMA_UNLOAD",          AM_CMD_GAMMA_UNLOAD,        0 },
+    { "ESSENCE",               AM_CMD_ESSENCE,             AML_CMD_EXPR },
+    { "JANUS",                 AM_CMD_JANUS,               0 },
+    { "JANUS_BLEND",           AM_CMD_JANUS_BLEND,         AML_CMD_EXPR },
+    { "GAMMA_DRIFT",           AM_CMD_GAMMA_DRIFT,         AML_CMD_EXPR },
+    { "ECHO",                  AM_CMD_ECHO,                0 },
+    { "TEMPORAL_MODE",         AM_CMD_TEMPORAL_MODE,       0 },
+    { "TEMPORAL_ALPHA",        AM_CMD_TEMPORAL_ALPHA,      AML_CMD_EXPR },
+    { "RTL_MODE",              AM_CMD_RTL_MODE,            0 },
+    { "PROPHECY_MODE",         AM_CMD_PROPHECY_MODE,       0 },
+    { "RETRODICTION_MODE",     AM_CMD_RETRODICTION_MODE,   0 },
+    { "EXPERT_STRUCTURAL",     AM_CMD_EXPERT_STRUCTURAL,   AML_CMD_EXPR },
+    { "EXPERT_SEMANTIC",       AM_CMD_EXPERT_SEMANTIC,     AML_CMD_EXPR },
+    { "EXPERT_CREATIVE",       AM_CMD_EXPERT_CREATIVE,     AML_CMD_EXPR },
+    { "EXPERT_PRECISE",        AM_CMD_EXPERT_PRECISE,      AML_CMD_EXPR },
+    { "PRESENCE_DECAY",        AM_CMD_PRESENCE_DECAY,      AML_CMD_EXPR },
+    { "MACRO",                 AM_CMD_MACRO,               0 },
+    { "BLOOD",                 AM_CMD_BLOOD,               0 },
+};
+#define AML_CMD_DEFS ((int)(sizeof(g_cmds) / sizeof(g_cmds[0])))
+
+static AML_PHash g_cmd_hash;
+
+__attribute__((constructor))
+static void cmd_hash_build(void) {
+    aml_phash_build(&g_cmd_hash, g_cmds, sizeof(AML_CmdDef), AML_CMD_DEFS);
+}
+
+// Command name → g_cmds index, -1 if unknown
+static int aml_cmd_find(const char* name) {
+    return aml_phash_find(&g_cmd_hash, g_cmds, sizeof(AML_CmdDef), name);
+}
+
+// Execute Level 0 command id (one of AM_CMD_*)
 // ctx may be NULL for backward compatibility
 // lineno is the source line number (0 if unknown)
-static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx, int lineno) {
-    const char* t = cmd;
-
+static void aml_exec_cmd(int id, const char* arg, AML_ExecCtx* ctx, int lineno) {
+  switch (id) {
     // PROPHECY PHYSICS — numeric args use ctx_float/ctx_int for expression support
-    if (!strcmp(t, "PROPHECY")) {
+    case AM_CMD_PROPHECY: {
       G.prophecy = clampi(ctx_int(ctx, arg), 1, 64);
+      break;
     }
-    else if (!strcmp(t, "DESTINY")) {
+    case AM_CMD_DESTINY: {
       G.destiny = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "WORMHOLE")) {
+    case AM_CMD_WORMHOLE: {
       G.wormhole = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "CALENDAR_DRIFT")) {
+    case AM_CMD_CALENDAR_DRIFT: {
       G.calendar_drift = clampf(ctx_float(ctx, arg), 0.0f, 30.0f);
+      break;
     }
 
     // ATTENTION PHYSICS
-    else if (!strcmp(t, "ATTEND_FOCUS")) {
+    case AM_CMD_ATTEND_FOCUS: {
       G.attend_focus = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "ATTEND_SPREAD")) {
+    case AM_CMD_ATTEND_SPREAD: {
       G.attend_spread = clamp01(ctx_float(ctx, arg));
+      break;
     }
 
     // TUNNELING
-    else if (!strcmp(t, "TUNNEL_THRESHOLD")) {
+    case AM_CMD_TUNNEL_THRESHOLD: {
       G.tunnel_threshold = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "TUNNEL_CHANCE")) {
+    case AM_CMD_TUNNEL_CHANCE: {
       G.tunnel_chance = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "TUNNEL_SKIP_MAX")) {
+    case AM_CMD_TUNNEL_SKIP_MAX: {
       G.tunnel_skip_max = clampi(ctx_int(ctx, arg), 1, 24);
+      break;
     }
 
     // SUFFERING
-    else if (!strcmp(t, "PAIN")) {
+    case AM_CMD_PAIN: {
       G.pain = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "TENSION")) {
+    case AM_CMD_TENSION: {
       G.tension = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "DISSONANCE")) {
+    case AM_CMD_DISSONANCE: {
       G.dissonance = clamp01(ctx_float(ctx, arg));
+      break;
     }
 
     // PROPHECY DEBT — direct set/configure
-    else if (!strcmp(t, "PROPHECY_DEBT")) {
+    case AM_CMD_PROPHECY_DEBT: {
       G.debt = clampf(ctx_float(ctx, arg), 0.0f, 100.0f);
+      break;
     }
-    else if (!strcmp(t, "PROPHECY_DEBT_DECAY")) {
+    case AM_CMD_PROPHECY_DEBT_DECAY: {
       G.debt_decay = clampf(ctx_float(ctx, arg), 0.9f, 0.9999f);
+      break;
     }
 
     // MOVEMENT
-    else if (!strcmp(t, "JUMP")) {
+    case AM_CMD_JUMP: {
       G.pending_jump = clampi(G.pending_jump + safe_atoi(arg), -1000, 1000);
+      break;
     }
-    else if (!strcmp(t, "VELOCITY")) {
+    case AM_CMD_VELOCITY: {
       // VELOCITY RUN|WALK|NOMOVE|BACKWARD or VELOCITY <int>
       char argup[32] = {0};
       snprintf(argup, sizeof(argup), "%.31s", arg);
@@ -1184,22 +1365,26 @@ static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx,
       else G.velocity_mode = clampi(safe_atoi(arg), -1, 2);
 
       update_effective_temp();
+      break;
     }
-    else if (!strcmp(t, "BASE_TEMP")) {
+    case AM_CMD_BASE_TEMP: {
       G.base_temperature = clampf(ctx_float(ctx, arg), 0.1f, 3.0f);
       update_effective_temp();
+      break;
     }
 
     // RESETS
-    else if (!strcmp(t, "RESET_FIELD")) {
+    case AM_CMD_RESET_FIELD: {
       am_reset_field();
+      break;
     }
-    else if (!strcmp(t, "RESET_DEBT")) {
+    case AM_CMD_RESET_DEBT: {
       am_reset_debt();
+      break;
     }
 
     // LAWS OF NATURE
-    else if (!strcmp(t, "LAW")) {
+    case AM_CMD_LAW: {
       // LAW has two tokens: lawname value_expr
       char lawname[64] = {0};
       char valexpr[128] = {0};
@@ -1232,13 +1417,14 @@ static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx,
           G.wormhole_gate = clamp01(lawval);
         }
       }
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // PACK MANAGEMENT
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "MODE") || !strcmp(t, "IMPORT")) {
+    case AM_CMD_MODE: {
       // MODE CODES_RIC or IMPORT CODES_RIC
       char packname[64] = {0};
       snprintf(packname, sizeof(packname), "%.63s", arg);
@@ -1248,8 +1434,9 @@ static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx,
         G.packs_enabled |= AM_PACK_CODES_RIC;
       }
       // DARKMATTER and NOTORCH are core — MODE accepted but no-op
+      break;
     }
-    else if (!strcmp(t, "DISABLE")) {
+    case AM_CMD_DISABLE: {
       char packname[64] = {0};
       snprintf(packname, sizeof(packname), "%.63s", arg);
       upcase(packname);
@@ -1258,81 +1445,61 @@ static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx,
         G.packs_enabled &= ~AM_PACK_CODES_RIC;
       }
       // DARKMATTER and NOTORCH are core — cannot be disabled
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // CODES/RIC PACK COMMANDS — ritual overlays (require pack enabled)
     // ─────────────────────────────────────────────────────────────────────────
 
-    // Namespaced: CODES.CHORDLOCK always works
-    else if (!strncmp(t, "CODES.", 6) || !strncmp(t, "RIC.", 4)) {
-      // auto-enable pack on namespaced use
-      G.packs_enabled |= AM_PACK_CODES_RIC;
-
-      const char* subcmd = t + (t[0] == 'C' ? 6 : 4); // skip CODES. or RIC.
-
-      if (!strcmp(subcmd, "CHORDLOCK")) {
-        char mode[16] = {0}; snprintf(mode, sizeof(mode), "%.15s", arg); upcase(mode);
-        G.chordlock_on = (!strcmp(mode, "ON") || !strcmp(mode, "1"));
-      }
-      else if (!strcmp(subcmd, "TEMPOLOCK")) {
-        char mode[16] = {0}; snprintf(mode, sizeof(mode), "%.15s", arg); upcase(mode);
-        G.tempolock_on = (!strcmp(mode, "ON") || !strcmp(mode, "1"));
-      }
-      else if (!strcmp(subcmd, "CHIRALITY")) {
-        char mode[16] = {0}; snprintf(mode, sizeof(mode), "%.15s", arg); upcase(mode);
-        G.chirality_on = (!strcmp(mode, "ON") || !strcmp(mode, "1"));
-      }
-      else if (!strcmp(subcmd, "TEMPO")) {
-        G.tempo = clampi(ctx_int(ctx, arg), 2, 47);
-      }
-      else if (!strcmp(subcmd, "PAS_THRESHOLD")) {
-        G.pas_threshold = clamp01(ctx_float(ctx, arg));
-      }
-    }
-
     // Unqualified: CHORDLOCK works only when pack enabled
-    else if (!strcmp(t, "CHORDLOCK")) {
+    case AM_CMD_CHORDLOCK: {
       if (G.packs_enabled & AM_PACK_CODES_RIC) {
         char mode[16] = {0}; snprintf(mode, sizeof(mode), "%.15s", arg); upcase(mode);
         G.chordlock_on = (!strcmp(mode, "ON") || !strcmp(mode, "1"));
       }
       // else: ignored (pack not enabled)
+      break;
     }
-    else if (!strcmp(t, "TEMPOLOCK")) {
+    case AM_CMD_TEMPOLOCK: {
       if (G.packs_enabled & AM_PACK_CODES_RIC) {
         char mode[16] = {0}; snprintf(mode, sizeof(mode), "%.15s", arg); upcase(mode);
         G.tempolock_on = (!strcmp(mode, "ON") || !strcmp(mode, "1"));
       }
+      break;
     }
-    else if (!strcmp(t, "CHIRALITY")) {
+    case AM_CMD_CHIRALITY: {
       if (G.packs_enabled & AM_PACK_CODES_RIC) {
         char mode[16] = {0}; snprintf(mode, sizeof(mode), "%.15s", arg); upcase(mode);
         G.chirality_on = (!strcmp(mode, "ON") || !strcmp(mode, "1"));
       }
+      break;
     }
-    else if (!strcmp(t, "TEMPO")) {
+    case AM_CMD_TEMPO: {
       if (G.packs_enabled & AM_PACK_CODES_RIC) {
         G.tempo = clampi(ctx_int(ctx, arg), 2, 47);
       }
+      break;
     }
-    else if (!strcmp(t, "PAS_THRESHOLD")) {
+    case AM_CMD_PAS_THRESHOLD: {
       if (G.packs_enabled & AM_PACK_CODES_RIC) {
         G.pas_threshold = clamp01(ctx_float(ctx, arg));
       }
+      break;
     }
-    else if (!strcmp(t, "ANCHOR")) {
+    case AM_CMD_ANCHOR: {
       if (G.packs_enabled & AM_PACK_CODES_RIC) {
         char mode[16] = {0}; snprintf(mode, sizeof(mode), "%.15s", arg); upcase(mode);
         if (!strcmp(mode, "PRIME")) G.chordlock_on = 1;
       }
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // DARK MATTER — core (no pack gate)
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "GRAVITY")) {
+    case AM_CMD_GRAVITY: {
       char subtype[16] = {0};
       float val = 0.5f;
       if (sscanf(arg, "%15s %f", subtype, &val) >= 1) {
@@ -1341,13 +1508,15 @@ static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx,
           G.dark_gravity = clamp01(val);
         }
       }
+      break;
     }
-    else if (!strcmp(t, "ANTIDOTE")) {
+    case AM_CMD_ANTIDOTE: {
       char mode[16] = {0}; snprintf(mode, sizeof(mode), "%.15s", arg); upcase(mode);
       if (!strcmp(mode, "AUTO")) G.antidote_mode = 0;
       else if (!strcmp(mode, "HARD")) G.antidote_mode = 1;
+      break;
     }
-    else if (!strcmp(t, "SCAR")) {
+    case AM_CMD_SCAR: {
       // Store scar text (gravitational memory)
       if (G.n_scars < AM_MAX_SCARS) {
         const char* text_start = arg;
@@ -1361,37 +1530,44 @@ static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx,
           G.scar_texts[G.n_scars][slen - 1] = 0;
         G.n_scars++;
       }
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // SCHUMANN / COSMIC PHYSICS — core
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "SCHUMANN")) {
+    case AM_CMD_SCHUMANN: {
       G.schumann_hz = clampf(ctx_float(ctx, arg), 7.0f, 8.5f);
       G.schumann_coherence = compute_schumann_coherence(G.schumann_hz);
+      break;
     }
-    else if (!strcmp(t, "SCHUMANN_MODULATION")) {
+    case AM_CMD_SCHUMANN_MODULATION: {
       G.schumann_modulation = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "COSMIC_COHERENCE")) {
+    case AM_CMD_COSMIC_COHERENCE: {
       G.schumann_coherence = clamp01(ctx_float(ctx, arg));
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // DELTA VOICE / NOTORCH — core
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "LORA_ALPHA")) {
+    case AM_CMD_LORA_ALPHA: {
       G.lora_alpha = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "NOTORCH_LR")) {
+    case AM_CMD_NOTORCH_LR: {
       G.notorch_lr = clampf(ctx_float(ctx, arg), 0.001f, 0.5f);
+      break;
     }
-    else if (!strcmp(t, "NOTORCH_DECAY")) {
+    case AM_CMD_NOTORCH_DECAY: {
       G.notorch_decay = clampf(ctx_float(ctx, arg), 0.9f, 0.9999f);
+      break;
     }
-    else if (!strcmp(t, "RESONANCE_BOOST")) {
+    case AM_CMD_RESONANCE_BOOST: {
       // RESONANCE_BOOST <word> <float> — boosts resonance metric
       // Per-token tracking requires vocabulary; kernel applies to field
       float val = 0.0f;
@@ -1399,47 +1575,53 @@ static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx,
       if (sscanf(arg, "%31s %f", word, &val) >= 2) {
         G.resonance = clamp01(G.resonance + clamp01(val) * 0.1f);
       }
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // 4.C — ASYNC FIELD FOREVER (seasons)
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "SEASON")) {
+    case AM_CMD_SEASON: {
       char sname[16] = {0}; snprintf(sname, sizeof(sname), "%.15s", arg); upcase(sname);
       if (!strcmp(sname, "SPRING")) G.season = AM_SEASON_SPRING;
       else if (!strcmp(sname, "SUMMER")) G.season = AM_SEASON_SUMMER;
       else if (!strcmp(sname, "AUTUMN")) G.season = AM_SEASON_AUTUMN;
       else if (!strcmp(sname, "WINTER")) G.season = AM_SEASON_WINTER;
       G.season_phase = 0.0f;
+      break;
     }
-    else if (!strcmp(t, "SEASON_INTENSITY")) {
+    case AM_CMD_SEASON_INTENSITY: {
       G.season_intensity = clamp01(ctx_float(ctx, arg));
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // GAMMA — personality essence (θ = ε + γ + αδ)
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "GAMMA")) {
+    case AM_CMD_GAMMA: {
       // GAMMA name alpha — load personality essence
       char name[32] = {0};
       float alpha = 1.0f;
       if (sscanf(arg, "%31s %f", name, &alpha) >= 1) {
         am_gamma_load(name, alpha);
       }
+      break;
     }
-    else if (!strcmp(t, "GAMMA_UNLOAD")) {
+    case AM_CMD_GAMMA_UNLOAD: {
       // GAMMA_UNLOAD name
       char name[32] = {0};
       sscanf(arg, "%31s", name);
       am_gamma_unload(name);
+      break;
     }
-    else if (!strcmp(t, "ESSENCE")) {
+    case AM_CMD_ESSENCE: {
       // ESSENCE alpha — overall gamma injection strength
       G.essence_alpha = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "JANUS")) {
+    case AM_CMD_JANUS: {
       // JANUS name_a name_b — dual-facing field
       char a[32] = {0}, b[32] = {0};
       if (sscanf(arg, "%31s %31s", a, b) == 2) {
@@ -1451,78 +1633,92 @@ static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx,
         else if (!strcmp(mode, "CYCLE")) G.janus_mode = AM_JANUS_CYCLE;
         else if (!strcmp(mode, "DUAL")) G.janus_mode = AM_JANUS_DUAL;
       }
+      break;
     }
-    else if (!strcmp(t, "JANUS_BLEND")) {
+    case AM_CMD_JANUS_BLEND: {
       G.janus_blend = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "GAMMA_DRIFT")) {
+    case AM_CMD_GAMMA_DRIFT: {
       G.gamma_drift = clampf(ctx_float(ctx, arg), 0.0f, 0.1f);
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // ECHO — debug output
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "ECHO")) {
+    case AM_CMD_ECHO: {
       printf("[AML] %s\n", arg);
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // TEMPORAL SYMMETRY — from PITOMADOM (past ≡ future)
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "TEMPORAL_MODE")) {
+    case AM_CMD_TEMPORAL_MODE: {
       char mode[32] = {0}; snprintf(mode, sizeof(mode), "%.31s", arg); upcase(mode);
       if (!strcmp(mode, "PROPHECY") || !strcmp(mode, "0")) G.temporal_mode = AM_TEMPORAL_PROPHECY;
       else if (!strcmp(mode, "RETRODICTION") || !strcmp(mode, "1")) G.temporal_mode = AM_TEMPORAL_RETRODICTION;
       else if (!strcmp(mode, "SYMMETRIC") || !strcmp(mode, "2")) G.temporal_mode = AM_TEMPORAL_SYMMETRIC;
+      break;
     }
-    else if (!strcmp(t, "TEMPORAL_ALPHA")) {
+    case AM_CMD_TEMPORAL_ALPHA: {
       G.temporal_alpha = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "RTL_MODE")) {
+    case AM_CMD_RTL_MODE: {
       char mode[16] = {0}; snprintf(mode, sizeof(mode), "%.15s", arg); upcase(mode);
       G.rtl_mode = (!strcmp(mode, "ON") || !strcmp(mode, "1"));
+      break;
     }
-    else if (!strcmp(t, "PROPHECY_MODE")) {
+    case AM_CMD_PROPHECY_MODE: {
       // Alias: PROPHECY_MODE ON = TEMPORAL_MODE PROPHECY
       G.temporal_mode = AM_TEMPORAL_PROPHECY;
+      break;
     }
-    else if (!strcmp(t, "RETRODICTION_MODE")) {
+    case AM_CMD_RETRODICTION_MODE: {
       // Alias: RETRODICTION_MODE ON = TEMPORAL_MODE RETRODICTION
       G.temporal_mode = AM_TEMPORAL_RETRODICTION;
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // EXPERT WEIGHTING — multi-expert temperature blend
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "EXPERT_STRUCTURAL")) {
+    case AM_CMD_EXPERT_STRUCTURAL: {
       G.expert_structural = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "EXPERT_SEMANTIC")) {
+    case AM_CMD_EXPERT_SEMANTIC: {
       G.expert_semantic = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "EXPERT_CREATIVE")) {
+    case AM_CMD_EXPERT_CREATIVE: {
       G.expert_creative = clamp01(ctx_float(ctx, arg));
+      break;
     }
-    else if (!strcmp(t, "EXPERT_PRECISE")) {
+    case AM_CMD_EXPERT_PRECISE: {
       G.expert_precise = clamp01(ctx_float(ctx, arg));
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // RESONANCE MEMORY — presence and decay
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "PRESENCE_DECAY")) {
+    case AM_CMD_PRESENCE_DECAY: {
       G.presence_decay = clamp01(ctx_float(ctx, arg));
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // LEVEL 1 MACROS — MACRO name { CMD1; CMD2 }
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "MACRO")) {
+    case AM_CMD_MACRO: {
       const char* brace = strchr(arg, '{');
       if (brace && g_macro_count < AML_MAX_MACROS) {
         char mname[AML_MAX_NAME] = {0};
@@ -1549,13 +1745,14 @@ static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx,
           g_macro_count++;
         }
       }
+      break;
     }
 
     // ─────────────────────────────────────────────────────────────────────────
     // BLOOD — runtime C compilation (Level 3)
     // ─────────────────────────────────────────────────────────────────────────
 
-    else if (!strcmp(t, "BLOOD")) {
+    case AM_CMD_BLOOD: {
       // BLOOD COMPILE <name> <code>     — compile raw C
       // BLOOD LORA <name> <in> <out> <rank> — generate + compile LoRA
       // BLOOD EMOTION <name> <valence> <arousal> — generate + compile emotional kernel
@@ -1613,13 +1810,47 @@ static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx,
           }
         }
       }
+      break;
+    }
+
+    default:
+      break;
+  }
+}
+
+
+
+// Execute a single Level 0 command (CMD + ARG already split, CMD already upcased)
+static void aml_exec_level0(const char* cmd, const char* arg, AML_ExecCtx* ctx, int lineno) {
+    int k = aml_cmd_find(cmd);
+    if (k >= 0) {
+        aml_exec_cmd(g_cmds[k].id, arg, ctx, lineno);
+        return;
+    }
+
+    // Namespaced: CODES.CHORDLOCK always works, and any CODES.* / RIC.*
+    // enables the pack
+    if (!strncmp(cmd, "CODES.", 6) || !strncmp(cmd, "RIC.", 4)) {
+        G.packs_enabled |= AM_PACK_CODES_RIC;
+        k = aml_cmd_find(cmd + (cmd[0] == 'C' ? 6 : 4));
+        if (k >= 0 && (g_cmds[k].flags & AML_CMD_NS))
+            aml_exec_cmd(g_cmds[k].id, arg, ctx, lineno);
     }
 
-    // ─────────────────────────────────────────────────────────────────────────
     // UNKNOWN COMMANDS — ignored intentionally (future-proof + vibe)
-    // ─────────────────────────────────────────────────────────────────────────
+}
+
+int am_cmd_id(const char* name) {
+    int k = name ? aml_cmd_find(name) : -1;
+    return k >= 0 ? g_cmds[k].id : -1;
+}
 
-    // else: silently ignored
+int am_exec_cmd(int id, const char* arg) {
+    if (id < 0 || id >= AM_CMD_COUNT) return 1;
+    g_error[0] = 0;
+    aml_exec_cmd(id, arg ? arg : "", NULL, 0);
+    am_field_plan_build();
+    return 0;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════
@@ -1676,9 +1907,6 @@ static int aml_find_block_end(AML_Line* lines, int nlines, int start) {
 // LEVEL 2 EXECUTION — if/else, while, def, assignment, function calls
 // ═══════════════════════════════════════════════════════════════════════════════
 
-// Forward declarations
-static int aml_exec_block(AML_ExecCtx* ctx, int start, int end);
-
 // Register all function definitions (first pass)
 static void aml_register_funcs(AML_ExecCtx* ctx) {
     for (int i = 0; i < ctx->nlines; i++) {
@@ -1724,124 +1952,461 @@ static void aml_register_funcs(AML_ExecCtx* ctx) {
     }
 }
 
-// Call a user-defined function
-// lineno is the caller's line number (for error reporting)
-static int aml_call_func(AML_ExecCtx* ctx, AML_Func* f, float* args, int nargs, int lineno) {
-    // Built-in functions: dispatch to C code directly
-    if (f->is_builtin) {
-        aml_exec_builtin(f->body_start, args, nargs);
-        return 0;
+// INCLUDE a file; fname is absolute or relative to ctx->base_dir
+static void aml_include(AML_ExecCtx* ctx, const char* fname, int lineno) {
+    if (ctx->include_depth >= AML_MAX_INCLUDE) {
+        set_error_at(ctx, lineno, "max include depth exceeded");
+        return;
     }
-
-    if (ctx->call_depth >= AML_MAX_CALL_DEPTH) {
-        set_error_at(ctx, lineno, "max call depth exceeded");
-        return 1;
+    char path[512];
+    if (fname[0] == '/') {
+        snprintf(path, sizeof(path), "%s", fname);
+    } else {
+        snprintf(path, sizeof(path), "%s/%s", ctx->base_dir, fname);
     }
 
-    // push local scope
-    ctx->call_depth++;
-    AML_Symtab* locals = &ctx->locals[ctx->call_depth - 1];
-    memset(locals, 0, sizeof(AML_Symtab));
+    ctx->include_depth++;
+    am_exec_file(path);
+    ctx->include_depth--;
+}
 
-    // bind params
-    for (int i = 0; i < f->param_count && i < nargs; i++) {
-        symtab_set(locals, f->params[i], args[i]);
+// Run macro @name (not found — ignore)
+static void aml_run_macro(const char* mname) {
+    for (int mi = 0; mi < g_macro_count; mi++) {
+        if (strcmp(g_macros[mi].name, mname) == 0) {
+            am_exec(g_macros[mi].body);
+            return;
+        }
     }
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// COMPILED SCRIPTS — am_compile / am_run
+// Each line is compiled once into a statement with its block structure
+// resolved; conditions, assigned values, call arguments and numeric Level 0
+// arguments become register bytecode, so a while loop re-evaluates code and
+// never re-reads text. am_exec compiles, runs once and frees; hosts keep the
+// AML_Program to run it again.
+// ═══════════════════════════════════════════════════════════════════════════════
 
-    // execute body
-    int rc = aml_exec_block(ctx, f->body_start, f->body_end);
+// An expression needs at most one register per pending operand; a 255-char
+// line cannot hold more than 127 of them.
+#define AML_VM_REGS 128
+
+enum {
+    VM_CONST, VM_LOAD, VM_FIELD,
+    VM_NEG, VM_NOT,
+    VM_MUL, VM_DIV, VM_ADD, VM_SUB,
+    VM_EQ, VM_NE, VM_GE, VM_LE, VM_GT, VM_LT,
+    VM_AND, VM_OR,
+    VM_ABS, VM_MIN, VM_MAX, VM_SQRT, VM_CLAMP,   // args in registers a, a+1, a+2
+};
 
-    // pop scope
-    ctx->call_depth--;
-    return rc;
+typedef struct {
+    uint8_t op, dst, a, b;          // register operands
+    union { float k; int name; } u; // VM_CONST value, VM_LOAD name, VM_FIELD id
+} AML_Op;
+
+// A compiled expression: code[at, at + n), result in register 0
+typedef struct { int at, n; } AML_Code;
+
+enum { ST_LEVEL0, ST_CMD, ST_DEF, ST_IF, ST_WHILE, ST_INCLUDE, ST_ASSIGN, ST_CALL, ST_MACRO };
+
+// One statement per preprocessed line
+typedef struct {
+    int         kind;
+    int         next;       // line after the statement (block end for def/if/while)
+    int         body_end;   // if/while: end of the body
+    int         else_end;   // if: end of the else block, == body_end without one
+    AML_Code    expr;       // if/while condition, assigned value
+    int         target;     // assignment: name index; call: function; AM_CMD_* id
+    int         nargs;      // call arguments; Level 0: 1 when expr is the argument
+    AML_Code    args[AML_MAX_PARAMS];
+    const char* cmd;        // Level 0 command (upcased), INCLUDE path, macro name
+    const char* arg;        // Level 0 argument
+} AML_Stmt;
+
+// A name used in the program, resolved against the field map once. Its
+// index is also its variable slot in every frame.
+typedef struct {
+    char name[AML_MAX_NAME];
+    int  field;             // AM_State field id, -1 if none
+    int  bound;             // assigned or a parameter somewhere in the program
+} AML_Name;
+
+struct AML_Program {
+    AML_ExecCtx ctx;
+    AML_Stmt*   stmts;
+    AML_Op*     code;
+    int         ncode, code_cap;
+    AML_Name*   names;
+    int         nnames, names_cap;
+    int       (*param_slots)[AML_MAX_PARAMS];   // per function
+    int         oom;
+};
+
+static int vm_find_name(const AML_Program* prog, const char* name) {
+    for (int i = 0; i < prog->nnames; i++)
+        if (strcmp(prog->names[i].name, name) == 0) return i;
+    return -1;
 }
 
-// Execute a single line in Level 2 context
-static int aml_exec_line(AML_ExecCtx* ctx, int idx) {
-    char* text = ctx->lines[idx].text;
+// Intern a variable name, returns its index (-1 when out of memory)
+static int vm_intern(AML_Program* prog, const char* name) {
+    int i = vm_find_name(prog, name);
+    if (i >= 0) return i;
+    if (prog->nnames == prog->names_cap) {
+        int cap = prog->names_cap ? 2 * prog->names_cap : 16;
+        AML_Name* grown = realloc(prog->names, (size_t)cap * sizeof(AML_Name));
+        if (!grown) { prog->oom = 1; return -1; }
+        prog->names = grown;
+        prog->names_cap = cap;
+    }
+    AML_Name* n = &prog->names[prog->nnames];
+    snprintf(n->name, AML_MAX_NAME, "%s", name);
+    n->field = field_find(n->name);
+    n->bound = 0;
+    return prog->nnames++;
+}
 
-    // --- def: skip (already registered) ---
-    if (strncmp(text, "def ", 4) == 0) {
-        // skip body
-        return aml_find_block_end(ctx->lines, ctx->nlines, idx);
+// Expression compiler state — mirrors AML_Expr, emitting code instead of values
+typedef struct {
+    const char*  p;
+    AML_Program* prog;
+    int          error;
+} AML_Cexpr;
+
+static AML_Op* vm_emit(AML_Cexpr* c, int op, int dst, int a, int b) {
+    AML_Program* prog = c->prog;
+    if (prog->ncode == prog->code_cap) {
+        int cap = prog->code_cap ? 2 * prog->code_cap : 64;
+        AML_Op* grown = realloc(prog->code, (size_t)cap * sizeof(AML_Op));
+        if (!grown) { prog->oom = 1; c->error = 1; return NULL; }
+        prog->code = grown;
+        prog->code_cap = cap;
+    }
+    AML_Op* o = &prog->code[prog->ncode++];
+    o->op = (uint8_t)op;
+    o->dst = (uint8_t)dst;
+    o->a = (uint8_t)a;
+    o->b = (uint8_t)b;
+    o->u.name = 0;
+    return o;
+}
+
+static void vm_const(AML_Cexpr* c, int r, float k) {
+    AML_Op* o = vm_emit(c, VM_CONST, r, 0, 0);
+    if (o) o->u.k = k;
+}
+
+static void cexpr_or(AML_Cexpr* c, int r);  // forward
+
+static void cexpr_skip_ws(AML_Cexpr* c) {
+    while (*c->p && isspace((unsigned char)*c->p)) c->p++;
+}
+
+// Each cexpr_* level leaves its value in register r and uses r+1.. as scratch
+static void cexpr_primary(AML_Cexpr* c, int r) {
+    cexpr_skip_ws(c);
+    if (c->error) return;
+    if (r >= AML_VM_REGS) { c->error = 1; return; }
+
+    if (*c->p == '(') {
+        c->p++;
+        cexpr_or(c, r);
+        cexpr_skip_ws(c);
+        if (*c->p == ')') c->p++;
+        return;
     }
 
-    // --- if/else ---
-    if (strncmp(text, "if ", 3) == 0) {
-        // strip trailing ':'
-        char cond[AML_MAX_LINE_LEN];
-        snprintf(cond, sizeof(cond), "%s", text + 3);
-        int clen = (int)strlen(cond);
-        if (clen > 0 && cond[clen - 1] == ':') cond[clen - 1] = 0;
+    if (isdigit((unsigned char)*c->p) || (*c->p == '.' && isdigit((unsigned char)c->p[1]))) {
+        char* end;
+        vm_const(c, r, strtof(c->p, &end));
+        c->p = end;
+        return;
+    }
+
+    if (isalpha((unsigned char)*c->p) || *c->p == '_') {
+        char name[AML_MAX_NAME] = {0};
+        int i = 0;
+        while ((isalnum((unsigned char)*c->p) || *c->p == '_') && i < AML_MAX_NAME - 1) {
+            name[i++] = *c->p++;
+        }
+        name[i] = 0;
 
-        float val = aml_eval(ctx, cond);
-        int body_end = aml_find_block_end(ctx->lines, ctx->nlines, idx);
-
-        // check for else
-        int has_else = 0;
-        int else_end = body_end;
-        if (body_end < ctx->nlines) {
-            char* next = ctx->lines[body_end].text;
-            if (strcmp(next, "else:") == 0 || strncmp(next, "else:", 5) == 0) {
-                has_else = 1;
-                else_end = aml_find_block_end(ctx->lines, ctx->nlines, body_end);
+        cexpr_skip_ws(c);
+
+        // function call: arguments land in r, r+1, ...
+        if (*c->p == '(') {
+            c->p++;
+            int mark = c->prog->ncode;
+            int nargs = 0;
+            cexpr_skip_ws(c);
+            if (*c->p != ')') {
+                cexpr_or(c, r + nargs++);
+                while (*c->p == ',' && nargs < AML_MAX_PARAMS) {
+                    c->p++;
+                    cexpr_or(c, r + nargs++);
+                }
+            }
+            cexpr_skip_ws(c);
+            if (*c->p == ')') c->p++;
+
+            // user-defined functions evaluate to 0 in expressions (see expr_primary)
+            int op = -1;
+            AML_Functab* ft = &c->prog->ctx.funcs;
+            int fi = 0;
+            while (fi < ft->count && strcmp(ft->funcs[fi].name, name) != 0) fi++;
+            if (fi == ft->count) {
+                if (strcasecmp(name, "abs") == 0 && nargs >= 1) op = VM_ABS;
+                else if (strcasecmp(name, "min") == 0 && nargs >= 2) op = VM_MIN;
+                else if (strcasecmp(name, "max") == 0 && nargs >= 2) op = VM_MAX;
+                else if (strcasecmp(name, "sqrt") == 0 && nargs >= 1) op = VM_SQRT;
+                else if (strcasecmp(name, "clamp") == 0 && nargs >= 3) op = VM_CLAMP;
             }
+            if (op < 0) {
+                c->prog->ncode = mark;
+                vm_const(c, r, 0.0f);
+            } else {
+                vm_emit(c, op, r, r, r + 1);
+            }
+            return;
         }
 
-        if (val != 0.0f) {
-            aml_exec_block(ctx, idx + 1, body_end);
-        } else if (has_else) {
-            aml_exec_block(ctx, body_end + 1, else_end);
+        if (strcmp(name, "true") == 0) { vm_const(c, r, 1.0f); return; }
+        if (strcmp(name, "false") == 0) { vm_const(c, r, 0.0f); return; }
+
+        int ni = vm_intern(c->prog, name);
+        AML_Op* o = ni < 0 ? NULL : vm_emit(c, VM_LOAD, r, 0, 0);
+        if (o) o->u.name = ni;
+        else c->error = 1;
+        return;
+    }
+
+    c->error = 1;
+}
+
+static void cexpr_unary(AML_Cexpr* c, int r) {
+    cexpr_skip_ws(c);
+    if (*c->p == '-') {
+        c->p++;
+        cexpr_unary(c, r);
+        vm_emit(c, VM_NEG, r, r, 0);
+        return;
+    }
+    if (strncmp(c->p, "not ", 4) == 0) {
+        c->p += 4;
+        cexpr_unary(c, r);
+        vm_emit(c, VM_NOT, r, r, 0);
+        return;
+    }
+    cexpr_primary(c, r);
+}
+
+static void cexpr_mul(AML_Cexpr* c, int r) {
+    cexpr_unary(c, r);
+    for (;;) {
+        cexpr_skip_ws(c);
+        int op;
+        if (*c->p == '*') op = VM_MUL;
+        else if (*c->p == '/' && c->p[1] != '/') op = VM_DIV;
+        else break;
+        c->p++;
+        cexpr_unary(c, r + 1);
+        vm_emit(c, op, r, r, r + 1);
+    }
+}
+
+static void cexpr_add(AML_Cexpr* c, int r) {
+    cexpr_mul(c, r);
+    for (;;) {
+        cexpr_skip_ws(c);
+        int op;
+        if (*c->p == '+') op = VM_ADD;
+        else if (*c->p == '-') op = VM_SUB;
+        else break;
+        c->p++;
+        cexpr_mul(c, r + 1);
+        vm_emit(c, op, r, r, r + 1);
+    }
+}
+
+static void cexpr_cmp(AML_Cexpr* c, int r) {
+    cexpr_add(c, r);
+    for (;;) {
+        cexpr_skip_ws(c);
+        int op, len = 2;
+        if (c->p[0] == '=' && c->p[1] == '=') op = VM_EQ;
+        else if (c->p[0] == '!' && c->p[1] == '=') op = VM_NE;
+        else if (c->p[0] == '>' && c->p[1] == '=') op = VM_GE;
+        else if (c->p[0] == '<' && c->p[1] == '=') op = VM_LE;
+        else if (*c->p == '>') { op = VM_GT; len = 1; }
+        else if (*c->p == '<') { op = VM_LT; len = 1; }
+        else break;
+        c->p += len;
+        cexpr_add(c, r + 1);
+        vm_emit(c, op, r, r, r + 1);
+    }
+}
+
+static void cexpr_and(AML_Cexpr* c, int r) {
+    cexpr_cmp(c, r);
+    for (;;) {
+        cexpr_skip_ws(c);
+        if (strncmp(c->p, "and ", 4) != 0) break;
+        c->p += 4;
+        cexpr_cmp(c, r + 1);
+        vm_emit(c, VM_AND, r, r, r + 1);
+    }
+}
+
+static void cexpr_or(AML_Cexpr* c, int r) {
+    cexpr_and(c, r);
+    for (;;) {
+        cexpr_skip_ws(c);
+        if (strncmp(c->p, "or ", 3) != 0) break;
+        c->p += 3;
+        cexpr_and(c, r + 1);
+        vm_emit(c, VM_OR, r, r, r + 1);
+    }
+}
+
+// Compile expression text; a parse error compiles to the constant 0, as aml_eval
+static AML_Code vm_compile_expr(AML_Program* prog, const char* text) {
+    AML_Cexpr c = { .p = text, .prog = prog, .error = 0 };
+    AML_Code code = { prog->ncode, 0 };
+    cexpr_or(&c, 0);
+    if (c.error) {
+        prog->ncode = code.at;
+        c.error = 0;
+        vm_const(&c, 0, 0.0f);
+    }
+    code.n = prog->ncode - code.at;
+    return code;
+}
+
+// Compile a Level 0 argument the way aml_eval_arg reads it: a plain
+// number when strtof takes the whole text, an expression otherwise
+static AML_Code vm_compile_arg(AML_Program* prog, const char* arg) {
+    char* end;
+    float val = strtof(arg, &end);
+    while (*end && isspace((unsigned char)*end)) end++;
+    if (*end) return vm_compile_expr(prog, arg);
+
+    AML_Cexpr c = { .p = arg, .prog = prog, .error = 0 };
+    AML_Code code = { prog->ncode, 0 };
+    vm_const(&c, 0, val);
+    code.n = prog->ncode - code.at;
+    return code;
+}
+
+// Slot read: the current call frame, then globals, then the field
+static inline float vm_load(const AML_ExecCtx* ctx, const AML_Program* prog, int slot) {
+    const AML_Frame* f = &ctx->frames[ctx->call_depth];
+    if (ctx->call_depth > 0 && f->set[slot]) return f->val[slot];
+    f = &ctx->frames[0];
+    if (f->set[slot]) return f->val[slot];
+    int field = prog->names[slot].field;
+    return field >= 0 ? field_get(field) : 0.0f;
+}
+
+static int resolve_sym(AML_ExecCtx* ctx, const char* name, float* out) {
+    const AML_Program* prog = ctx->prog;
+    if (!prog) return 0;
+    int slot = vm_find_name(prog, name);
+    if (slot < 0) return 0;
+    const AML_Frame* f = &ctx->frames[ctx->call_depth];
+    if (ctx->call_depth > 0 && f->set[slot]) { *out = f->val[slot]; return 1; }
+    f = &ctx->frames[0];
+    if (f->set[slot]) { *out = f->val[slot]; return 1; }
+    return 0;
+}
+
+static float vm_eval(AML_ExecCtx* ctx, const AML_Program* prog, AML_Code code) {
+    float r[AML_VM_REGS];
+    const AML_Op* o = prog->code + code.at;
+    for (const AML_Op* end = o + code.n; o < end; o++) {
+        float* d = &r[o->dst];
+        const float* a = &r[o->a];
+        float x, y;
+        switch (o->op) {
+        case VM_CONST: *d = o->u.k; continue;
+        case VM_LOAD:  *d = vm_load(ctx, prog, o->u.name); continue;
+        case VM_FIELD: *d = field_get(o->u.name); continue;
+        case VM_NEG:   *d = -*a; continue;
+        case VM_NOT:   *d = *a == 0.0f ? 1.0f : 0.0f; continue;
+        case VM_ABS:   *d = fabsf(*a); continue;
+        case VM_SQRT:  *d = sqrtf(fabsf(*a)); continue;
+        case VM_CLAMP: *d = clampf(a[0], a[1], a[2]); continue;
+        default:       break;
+        }
+        x = *a;
+        y = r[o->b];
+        switch (o->op) {
+        case VM_MUL:   *d = x * y; break;
+        case VM_DIV:   *d = (y != 0.0f) ? x / y : 0.0f; break;
+        case VM_ADD:   *d = x + y; break;
+        case VM_SUB:   *d = x - y; break;
+        case VM_EQ:    *d = (x == y) ? 1.0f : 0.0f; break;
+        case VM_NE:    *d = (x != y) ? 1.0f : 0.0f; break;
+        case VM_GE:    *d = (x >= y) ? 1.0f : 0.0f; break;
+        case VM_LE:    *d = (x <= y) ? 1.0f : 0.0f; break;
+        case VM_GT:    *d = (x > y) ? 1.0f : 0.0f; break;
+        case VM_LT:    *d = (x < y) ? 1.0f : 0.0f; break;
+        case VM_AND:   *d = (x != 0.0f && y != 0.0f) ? 1.0f : 0.0f; break;
+        case VM_OR:    *d = (x != 0.0f || y != 0.0f) ? 1.0f : 0.0f; break;
+        case VM_MIN:   *d = x < y ? x : y; break;
+        case VM_MAX:   *d = x > y ? x : y; break;
+        default:       *d = 0.0f; break;
         }
+    }
+    return r[0];
+}
 
-        return has_else ? else_end : body_end;
+// Compile line idx: def, if/while, INCLUDE, assignment, call, @macro, Level 0
+static void vm_compile_line(AML_Program* prog, int idx) {
+    AML_ExecCtx* ctx = &prog->ctx;
+    AML_Stmt* s = &prog->stmts[idx];
+    char* text = ctx->lines[idx].text;
+    s->next = idx + 1;
+
+    if (strncmp(text, "def ", 4) == 0) {
+        s->kind = ST_DEF;
+        s->next = aml_find_block_end(ctx->lines, ctx->nlines, idx);
+        return;
     }
 
-    // --- while ---
-    if (strncmp(text, "while ", 6) == 0) {
+    if (strncmp(text, "if ", 3) == 0 || strncmp(text, "while ", 6) == 0) {
+        int is_if = text[0] == 'i';
         char cond[AML_MAX_LINE_LEN];
-        snprintf(cond, sizeof(cond), "%s", text + 6);
+        snprintf(cond, sizeof(cond), "%s", text + (is_if ? 3 : 6));
         int clen = (int)strlen(cond);
         if (clen > 0 && cond[clen - 1] == ':') cond[clen - 1] = 0;
 
-        int body_end = aml_find_block_end(ctx->lines, ctx->nlines, idx);
-        int iterations = 0;
-
-        while (aml_eval(ctx, cond) != 0.0f && iterations < 10000) {
-            aml_exec_block(ctx, idx + 1, body_end);
-            iterations++;
+        s->kind = is_if ? ST_IF : ST_WHILE;
+        s->expr = vm_compile_expr(prog, cond);
+        s->body_end = s->else_end = aml_find_block_end(ctx->lines, ctx->nlines, idx);
+        if (is_if && s->body_end < ctx->nlines &&
+            strncmp(ctx->lines[s->body_end].text, "else:", 5) == 0) {
+            s->else_end = aml_find_block_end(ctx->lines, ctx->nlines, s->body_end);
         }
-        return body_end;
+        s->next = s->else_end;
+        return;
     }
 
-    // --- INCLUDE ---
     if (strncasecmp(text, "INCLUDE ", 8) == 0) {
-        if (ctx->include_depth >= AML_MAX_INCLUDE) {
-            set_error_at(ctx, ctx->lines[idx].lineno, "max include depth exceeded");
-            return idx + 1;
-        }
-        char path[512];
         const char* fname = text + 8;
         while (*fname == ' ') fname++;
-
-        if (fname[0] == '/') {
-            snprintf(path, sizeof(path), "%s", fname);
-        } else {
-            snprintf(path, sizeof(path), "%s/%s", ctx->base_dir, fname);
-        }
-
-        ctx->include_depth++;
-        am_exec_file(path);
-        ctx->include_depth--;
-        return idx + 1;
+        s->kind = ST_INCLUDE;
+        s->cmd = fname;
+        return;
     }
 
-    // --- assignment: name = expr ---
+    // assignment: name = expr
     {
         const char* eq = strchr(text, '=');
         if (eq && eq > text && eq[1] != '=' && eq[-1] != '!' &&
             eq[-1] != '<' && eq[-1] != '>') {
-            // extract variable name
             char varname[AML_MAX_NAME] = {0};
             const char* p = text;
             int ni = 0;
@@ -1853,17 +2418,16 @@ static int aml_exec_line(AML_ExecCtx* ctx, int idx) {
             varname[ni] = 0;
 
             if (ni > 0 && (isalpha((unsigned char)varname[0]) || varname[0] == '_')) {
-                float val = aml_eval(ctx, eq + 1);
-                if (ctx->call_depth > 0)
-                    symtab_set(&ctx->locals[ctx->call_depth - 1], varname, val);
-                else
-                    symtab_set(&ctx->globals, varname, val);
-                return idx + 1;
+                s->kind = ST_ASSIGN;
+                s->target = vm_intern(prog, varname);
+                if (s->target >= 0) prog->names[s->target].bound = 1;
+                s->expr = vm_compile_expr(prog, eq + 1);
+                return;
             }
         }
     }
 
-    // --- function call: name(args) ---
+    // function call: name(args) — unknown names fall through to Level 0
     {
         char* paren = strchr(text, '(');
         if (paren && !strchr(text, '=')) {
@@ -1877,127 +2441,277 @@ static int aml_exec_line(AML_ExecCtx* ctx, int idx) {
             }
             fname[ni] = 0;
 
-            // find function
             for (int fi = 0; fi < ctx->funcs.count; fi++) {
-                if (strcmp(ctx->funcs.funcs[fi].name, fname) == 0) {
-                    // parse args
-                    float args[AML_MAX_PARAMS];
-                    int nargs = 0;
-                    char argbuf[AML_MAX_LINE_LEN];
-                    char* ap = paren + 1;
-                    char* close = strchr(ap, ')');
-                    if (close) {
-                        int alen = (int)(close - ap);
-                        memcpy(argbuf, ap, alen);
-                        argbuf[alen] = 0;
-                        // split by comma
-                        char* save = NULL;
-                        for (char* tok = strtok_r(argbuf, ",", &save);
-                             tok && nargs < AML_MAX_PARAMS;
-                             tok = strtok_r(NULL, ",", &save)) {
-                            while (*tok == ' ') tok++;
-                            args[nargs++] = aml_eval(ctx, tok);
-                        }
+                if (strcmp(ctx->funcs.funcs[fi].name, fname) != 0) continue;
+                s->kind = ST_CALL;
+                s->target = fi;
+                s->nargs = 0;
+                char argbuf[AML_MAX_LINE_LEN];
+                char* ap = paren + 1;
+                char* close = strchr(ap, ')');
+                if (close) {
+                    int alen = (int)(close - ap);
+                    memcpy(argbuf, ap, alen);
+                    argbuf[alen] = 0;
+                    char* save = NULL;
+                    for (char* tok = strtok_r(argbuf, ",", &save);
+                         tok && s->nargs < AML_MAX_PARAMS;
+                         tok = strtok_r(NULL, ",", &save)) {
+                        while (*tok == ' ') tok++;
+                        s->args[s->nargs++] = vm_compile_expr(prog, tok);
                     }
-                    aml_call_func(ctx, &ctx->funcs.funcs[fi], args, nargs, ctx->lines[idx].lineno);
-                    return idx + 1;
                 }
+                return;
             }
         }
     }
 
-    // --- macro call @name ---
     if (text[0] == '@') {
         const char* mname = text + 1;
         while (*mname == ' ') mname++;
-        for (int mi = 0; mi < g_macro_count; mi++) {
-            if (strcmp(g_macros[mi].name, mname) == 0) {
-                am_exec(g_macros[mi].body);
-                return idx + 1;
-            }
-        }
-        return idx + 1;  // macro not found — ignore
+        s->kind = ST_MACRO;
+        s->cmd = mname;
+        return;
+    }
+
+    // Level 0: split CMD ARG in place, the program owns its lines
+    char* sp = text;
+    while (*sp && !isspace((unsigned char)*sp)) sp++;
+    char* cmd_end = sp;
+    while (*sp && isspace((unsigned char)*sp)) sp++;
+    *cmd_end = 0;
+    upcase(text);
+    int k = aml_cmd_find(text);
+    s->kind = k >= 0 ? ST_CMD : ST_LEVEL0;   // namespaced and unknown: by name
+    s->target = k >= 0 ? g_cmds[k].id : -1;
+    s->cmd = text;
+    s->arg = sp;
+    if (k >= 0 && (g_cmds[k].flags & AML_CMD_EXPR)) {
+        s->nargs = 1;
+        s->expr = vm_compile_arg(prog, sp);
     }
+}
 
-    // --- Level 0 fallback: split CMD ARG, dispatch ---
-    {
-        char linebuf[AML_MAX_LINE_LEN];
-        snprintf(linebuf, sizeof(linebuf), "%s", text);
-
-        char* sp = linebuf;
-        while (*sp && !isspace((unsigned char)*sp)) sp++;
-        char* cmd_end = sp;
-        while (*sp && isspace((unsigned char)*sp)) sp++;
-        char* arg = sp;
-        *cmd_end = 0;
-        upcase(linebuf);
+static int vm_exec_block(AML_Program* prog, int start, int end);
 
-        aml_exec_level0(linebuf, arg, ctx, ctx->lines[idx].lineno);
+// Frame for call depth d, allocated on first use and sized to the program
+static AML_Frame* vm_frame(AML_ExecCtx* ctx, int d) {
+    AML_Frame* f = &ctx->frames[d];
+    if (!f->val) {
+        int n = ctx->nslots ? ctx->nslots : 1;
+        f->val = (float*)malloc((size_t)n * (sizeof(float) + 1));
+        if (!f->val) return NULL;
+        f->set = (uint8_t*)(f->val + n);
+        memset(f->set, 0, (size_t)n);
     }
-    return idx + 1;
+    return f;
 }
 
-// Execute a block of lines [start, end)
-static int aml_exec_block(AML_ExecCtx* ctx, int start, int end) {
-    int i = start;
-    while (i < end && i < ctx->nlines) {
-        i = aml_exec_line(ctx, i);
+static int vm_call_func(AML_Program* prog, AML_Func* f, float* args, int nargs, int lineno) {
+    AML_ExecCtx* ctx = &prog->ctx;
+    if (f->is_builtin) {
+        aml_exec_builtin(f->body_start, args, nargs);
+        return 0;
     }
-    return 0;
-}
-
-// ═══════════════════════════════════════════════════════════════════════════════
-// PUBLIC EXEC — AML Level 0 + Level 2
-// ═══════════════════════════════════════════════════════════════════════════════
-
-int am_exec(const char* script) {
-    if (!script || !*script) return 0;
-    g_error[0] = 0;
-
-    // preprocess into lines
-    AML_Line* lines = (AML_Line*)malloc(AML_MAX_LINES * sizeof(AML_Line));
-    if (!lines) return 2;
-
-    int nlines = aml_preprocess(script, lines, AML_MAX_LINES);
-    if (nlines == 0) { free(lines); return 0; }
-
-    // set up execution context
-    AML_ExecCtx ctx;
-    memset(&ctx, 0, sizeof(ctx));
-    ctx.lines = lines;
-    ctx.nlines = nlines;
-
-    // register built-in functions (native AML, not external bindings)
-    aml_register_builtins(&ctx);
-
-    // first pass: register user-defined function definitions
-    aml_register_funcs(&ctx);
-
-    // second pass: execute top-level block
-    aml_exec_block(&ctx, 0, nlines);
-
-    free(lines);
-
-    if (ctx.error[0]) {
-        snprintf(g_error, sizeof(g_error), "%s", ctx.error);
+    if (ctx->call_depth >= AML_MAX_CALL_DEPTH) {
+        set_error_at(ctx, lineno, "max call depth exceeded");
         return 1;
     }
-    return 0;
-}
 
-int am_exec_file(const char* path) {
-    if (!path) return 1;
-    g_error[0] = 0;
-
-    FILE* f = fopen(path, "r");
-    if (!f) {
-        snprintf(g_error, 256, "cannot open: %s", path);
+    AML_Frame* fr = vm_frame(ctx, ctx->call_depth + 1);
+    if (!fr) {
+        set_error_at(ctx, lineno, "out of memory");
         return 1;
     }
+    ctx->call_depth++;
+    memset(fr->set, 0, (size_t)ctx->nslots);
+    const int* slots = prog->param_slots[f - ctx->funcs.funcs];
+    for (int i = 0; i < f->param_count && i < nargs; i++) {
+        fr->val[slots[i]] = args[i];
+        fr->set[slots[i]] = 1;
+    }
+    int rc = vm_exec_block(prog, f->body_start, f->body_end);
+    ctx->call_depth--;
+    return rc;
+}
 
-    fseek(f, 0, SEEK_END);
-    long sz = ftell(f);
-    fseek(f, 0, SEEK_SET);
+static int vm_exec_stmt(AML_Program* prog, int idx) {
+    AML_ExecCtx* ctx = &prog->ctx;
+    const AML_Stmt* s = &prog->stmts[idx];
+    int lineno = ctx->lines[idx].lineno;
+
+    switch (s->kind) {
+    case ST_IF:
+        if (vm_eval(ctx, prog, s->expr) != 0.0f)
+            vm_exec_block(prog, idx + 1, s->body_end);
+        else if (s->else_end != s->body_end)
+            vm_exec_block(prog, s->body_end + 1, s->else_end);
+        break;
+    case ST_WHILE: {
+        int iterations = 0;
+        while (vm_eval(ctx, prog, s->expr) != 0.0f && iterations < 10000) {
+            vm_exec_block(prog, idx + 1, s->body_end);
+            iterations++;
+        }
+        break;
+    }
+    case ST_INCLUDE:
+        aml_include(ctx, s->cmd, lineno);
+        break;
+    case ST_ASSIGN: {
+        float val = vm_eval(ctx, prog, s->expr);
+        AML_Frame* f = &ctx->frames[ctx->call_depth];
+        f->val[s->target] = val;
+        f->set[s->target] = 1;
+        break;
+    }
+    case ST_CALL: {
+        float args[AML_MAX_PARAMS];
+        for (int i = 0; i < s->nargs; i++) args[i] = vm_eval(ctx, prog, s->args[i]);
+        vm_call_func(prog, &ctx->funcs.funcs[s->target], args, s->nargs, lineno);
+        break;
+    }
+    case ST_MACRO:
+        aml_run_macro(s->cmd);
+        break;
+    case ST_CMD:
+        if (s->nargs) {
+            ctx->arg_text = s->arg;
+            ctx->arg_value = vm_eval(ctx, prog, s->expr);
+        }
+        aml_exec_cmd(s->target, s->arg, ctx, lineno);
+        ctx->arg_text = NULL;
+        break;
+    case ST_LEVEL0:
+        aml_exec_level0(s->cmd, s->arg, ctx, lineno);
+        break;
+    default:
+        break;
+    }
+    return s->next;
+}
+
+static int vm_exec_block(AML_Program* prog, int start, int end) {
+    int i = start;
+    while (i < end && i < prog->ctx.nlines) {
+        i = vm_exec_stmt(prog, i);
+    }
+    return 0;
+}
+
+// Give every parameter its slot, size the frames to the name table, and
+// turn loads of names nothing assigns into plain field reads (or 0): those
+// can never be shadowed by a variable
+static void vm_bind_slots(AML_Program* prog) {
+    AML_Functab* ft = &prog->ctx.funcs;
+    prog->param_slots = calloc(ft->count ? ft->count : 1, sizeof(*prog->param_slots));
+    if (!prog->param_slots) { prog->oom = 1; return; }
+    for (int fi = 0; fi < ft->count; fi++) {
+        if (ft->funcs[fi].is_builtin) continue;
+        for (int pi = 0; pi < ft->funcs[fi].param_count; pi++) {
+            int ni = vm_intern(prog, ft->funcs[fi].params[pi]);
+            if (ni < 0) return;
+            prog->names[ni].bound = 1;
+            prog->param_slots[fi][pi] = ni;
+        }
+    }
+    for (int i = 0; i < prog->ncode; i++) {
+        AML_Op* o = &prog->code[i];
+        if (o->op != VM_LOAD || prog->names[o->u.name].bound) continue;
+        int field = prog->names[o->u.name].field;
+        if (field >= 0) {
+            o->op = VM_FIELD;
+            o->u.name = field;
+        } else {
+            o->op = VM_CONST;
+            o->u.k = 0.0f;
+        }
+    }
+    prog->ctx.nslots = prog->nnames;
+    if (!vm_frame(&prog->ctx, 0)) prog->oom = 1;
+}
+
+AML_Program* am_compile(const char* script) {
+    g_error[0] = 0;
+    AML_Program* prog = (AML_Program*)calloc(1, sizeof(AML_Program));
+    AML_Line* lines = (AML_Line*)malloc(AML_MAX_LINES * sizeof(AML_Line));
+    if (!prog || !lines) { free(prog); free(lines); return NULL; }
+
+    int nlines = script ? aml_preprocess(script, lines, AML_MAX_LINES) : 0;
+    AML_Line* fit = (AML_Line*)realloc(lines, (nlines ? nlines : 1) * sizeof(AML_Line));
+    if (fit) lines = fit;
+    prog->ctx.prog = prog;
+    prog->ctx.lines = lines;
+    prog->ctx.nlines = nlines;
+
+    aml_register_builtins(&prog->ctx);
+    aml_register_funcs(&prog->ctx);
+
+    prog->stmts = (AML_Stmt*)calloc(nlines ? nlines : 1, sizeof(AML_Stmt));
+    if (!prog->stmts) { am_program_free(prog); return NULL; }
+    for (int i = 0; i < nlines; i++) vm_compile_line(prog, i);
+    if (!prog->oom) vm_bind_slots(prog);
+    if (prog->oom) { am_program_free(prog); return NULL; }
+    return prog;
+}
+
+int am_run(AML_Program* prog) {
+    if (!prog) return 2;
+    g_error[0] = 0;
+
+    AML_ExecCtx* ctx = &prog->ctx;
+    if (ctx->nlines == 0) return 0;
+    memset(ctx->frames[0].set, 0, (size_t)ctx->nslots);
+    ctx->call_depth = 0;
+    ctx->include_depth = 0;
+    ctx->error[0] = 0;
+
+    vm_exec_block(prog, 0, ctx->nlines);
+    am_field_plan_build();
+
+    if (ctx->error[0]) {
+        snprintf(g_error, sizeof(g_error), "%s", ctx->error);
+        return 1;
+    }
+    return 0;
+}
+
+void am_program_free(AML_Program* prog) {
+    if (!prog) return;
+    for (int d = 0; d <= AML_MAX_CALL_DEPTH; d++) free(prog->ctx.frames[d].val);
+    free(prog->ctx.lines);
+    free(prog->stmts);
+    free(prog->param_slots);
+    free(prog->code);
+    free(prog->names);
+    free(prog);
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// PUBLIC EXEC — AML Level 0 + Level 2
+// ═══════════════════════════════════════════════════════════════════════════════
+
+int am_exec(const char* script) {
+    if (!script || !*script) return 0;
+    AML_Program* prog = am_compile(script);
+    int rc = am_run(prog);
+    am_program_free(prog);
+    return rc;
+}
+
+int am_exec_file(const char* path) {
+    if (!path) return 1;
+    g_error[0] = 0;
+
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        snprintf(g_error, 256, "cannot open: %s", path);
+        return 1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long sz = ftell(f);
+    fseek(f, 0, SEEK_SET);
 
     if (sz <= 0 || sz > 1024 * 1024) {
         fclose(f);
@@ -2063,162 +2777,2335 @@ int am_copy_state(float* out) {
   out[18] = (float)G.packs_enabled;
   out[19] = (float)G.chordlock_on;  // sample pack state
 
-  // Schumann / cosmic
-  out[20] = G.schumann_coherence;
-  out[21] = (float)G.wormhole_active;
-  // Delta / notorch
-  out[22] = G.lora_alpha;
-  out[23] = G.notorch_lr;
-  // Live metrics
-  out[24] = G.entropy;
-  out[25] = G.resonance;
-  out[26] = G.emergence;
-  out[27] = G.destiny_bias;
-  // Schumann extended
-  out[28] = G.schumann_hz;
-  out[29] = G.schumann_phase;
-  // Season
-  out[30] = (float)G.season;
-  out[31] = G.season_phase;
+  // Schumann / cosmic
+  out[20] = G.schumann_coherence;
+  out[21] = (float)G.wormhole_active;
+  // Delta / notorch
+  out[22] = G.lora_alpha;
+  out[23] = G.notorch_lr;
+  // Live metrics
+  out[24] = G.entropy;
+  out[25] = G.resonance;
+  out[26] = G.emergence;
+  out[27] = G.destiny_bias;
+  // Schumann extended
+  out[28] = G.schumann_hz;
+  out[29] = G.schumann_phase;
+  // Season
+  out[30] = (float)G.season;
+  out[31] = G.season_phase;
+
+  return 0;
+}
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// LOGIT MANIPULATION API — apply field state to generation
+// Ported from arianna_dsl.c, ariannamethod.lang/src/field.js
+//
+// Every stage is a reduction (sum / max / top-2) followed by a rewrite, so
+// each stage is built from the same five kernels. The kernels come in
+// scalar, AVX2, AVX-512 and NEON flavours, picked at load time.
+// ═══════════════════════════════════════════════════════════════════════════════
+
+typedef struct {
+    float max;      // largest logit
+    float second;   // runner-up (-1e30 sentinel when nothing beat it)
+    float mean;     // arithmetic mean
+} AM_LogitStats;
+
+typedef struct {
+    float a, b;     // affine part: y = a*x + b
+    float xmax;     // input max — the entries laws hits hardest
+    float r_top;    // laws reduction for entries equal to the max
+    float near;     // resonance ceiling band: y >= near ...
+    float r2;       // ... takes this reduction
+} AM_FieldXform;
+
+// top-2 with a tie rule: a repeated max fills second too
+static inline void top2_push(float v, float* mx, float* sec) {
+    if (v > *mx) { if (*mx > *sec) *sec = *mx; *mx = v; }
+    else if (v > *sec) *sec = v;
+}
+
+// ── scalar kernels ───────────────────────────────────────────────────────────
+
+static float lk_sum_scalar(const float* x, int n) {
+    float sum = 0.0f;
+    for (int i = 0; i < n; i++) sum += x[i];
+    return sum;
+}
+
+static float lk_max_scalar(const float* x, int n) {
+    float mx = x[0];
+    for (int i = 1; i < n; i++) if (x[i] > mx) mx = x[i];
+    return mx;
+}
+
+static void lk_stats_scalar(const float* x, int n, AM_LogitStats* s) {
+    float mx = -INFINITY, sec = -1e30f, sum = 0.0f;
+    for (int i = 0; i < n; i++) {
+        sum += x[i];
+        top2_push(x[i], &mx, &sec);
+    }
+    s->max = mx;
+    s->second = sec;
+    s->mean = sum / (float)n;
+}
+
+static void lk_affine_scalar(float* x, int n, float a, float b) {
+    for (int i = 0; i < n; i++) x[i] = a * x[i] + b;
+}
+
+// Branch-free laws: keyed on the input max, so the compare never depends
+// on how the affine part rounded. Returns the max of what it wrote.
+static float lk_rewrite_scalar(float* x, int n, const AM_FieldXform* t) {
+    const float a = t->a, b = t->b, xmax = t->xmax;
+    const float r_top = t->r_top, near = t->near, r2 = t->r2;
+    float mx = -INFINITY;
+    for (int i = 0; i < n; i++) {
+        float y = a * x[i] + b;
+        float band = (y >= near) ? r2 : 0.0f;
+        x[i] = y - ((x[i] >= xmax) ? r_top : band);
+        if (x[i] > mx) mx = x[i];
+    }
+    return mx;
+}
+
+// Sampler pass: rewrite in place and emit softmax weights exp((y - m) / T)
+// against a reference m; returns their sum and the block max of y.
+static float lk_rewrite_exp_scalar(float* x, int n, const AM_FieldXform* t,
+                                   float m, float inv_t, float* w, float* bmax) {
+    const float a = t->a, b = t->b, xmax = t->xmax;
+    const float r_top = t->r_top, near = t->near, r2 = t->r2;
+    float sum = 0.0f, mx = -INFINITY;
+    for (int i = 0; i < n; i++) {
+        float y = a * x[i] + b;
+        float band = (y >= near) ? r2 : 0.0f;
+        y -= (x[i] >= xmax) ? r_top : band;
+        x[i] = y;
+        w[i] = expf((y - m) * inv_t);
+        sum += w[i];
+        if (y > mx) mx = y;
+    }
+    *bmax = mx;
+    return sum;
+}
+
+// Fold per-lane top-2 and the scalar tail into final stats (SIMD kernels)
+__attribute__((unused))
+static void lk_stats_merge(const float* lm, const float* l2, int lanes,
+                           float sum, const float* x, int i, int n,
+                           AM_LogitStats* s) {
+    float mx = -INFINITY, sec = -1e30f;
+    for (int l = 0; l < lanes; l++) {
+        top2_push(lm[l], &mx, &sec);
+        top2_push(l2[l], &mx, &sec);
+    }
+    for (; i < n; i++) {
+        sum += x[i];
+        top2_push(x[i], &mx, &sec);
+    }
+    s->max = mx;
+    s->second = sec;
+    s->mean = sum / (float)n;
+}
+
+// ── half-precision rows ─────────────────────────────────────────────────────
+// bf16 / fp16 logits are widened to fp32 in registers: stats accumulate in
+// fp32 and the rewrite rounds back to nearest-even in the native format.
+
+enum { LF_F32, LF_BF16, LF_FP16 };   // row storage formats
+
+static inline uint32_t f32_bits(float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+static inline float bits_f32(uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+
+float am_bf16_to_float(uint16_t h) { return bits_f32((uint32_t)h << 16); }
+
+uint16_t am_float_to_bf16(float f) {
+    uint32_t u = f32_bits(f);
+    if ((u & 0x7FFFFFFFu) > 0x7F800000u) return (uint16_t)((u >> 16) | 0x40);  // quiet NaN
+    return (uint16_t)((u + 0x7FFFu + ((u >> 16) & 1u)) >> 16);
+}
+
+float am_fp16_to_float(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1Fu, man = h & 0x3FFu;
+    if (exp == 0x1F) return bits_f32(sign | 0x7F800000u | (man << 13));
+    if (exp) return bits_f32(sign | ((exp + 112u) << 23) | (man << 13));
+    float v = (float)man * 5.9604645e-8f;   // subnormal: man * 2^-24
+    return sign ? -v : v;
+}
+
+uint16_t am_float_to_fp16(float f) {
+    uint32_t u = f32_bits(f);
+    uint16_t sign = (uint16_t)((u >> 16) & 0x8000u);
+    uint32_t a = u & 0x7FFFFFFFu;
+    if (a > 0x7F800000u) return sign | 0x7E00;            // NaN
+    if (a >= 0x477FF000u) return sign | 0x7C00;           // >= 65520 rounds to inf
+    if (a < 0x38800000u)                                  // below 2^-14: subnormal
+        return sign | (uint16_t)lrintf(bits_f32(a) * 16777216.0f);
+    a += 0xFFFu + ((a >> 13) & 1u);
+    return sign | (uint16_t)((a - 0x38000000u) >> 13);
+}
+
+static inline float half_get(const uint16_t* x, int i, int fmt) {
+    return (fmt == LF_FP16) ? am_fp16_to_float(x[i]) : am_bf16_to_float(x[i]);
+}
+
+static inline uint16_t half_put(float v, int fmt) {
+    return (fmt == LF_FP16) ? am_float_to_fp16(v) : am_float_to_bf16(v);
+}
+
+static void lk_stats_h_scalar(const uint16_t* x, int n, int fmt, AM_LogitStats* s) {
+    float mx = -INFINITY, sec = -1e30f, sum = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float v = half_get(x, i, fmt);
+        sum += v;
+        top2_push(v, &mx, &sec);
+    }
+    s->max = mx;
+    s->second = sec;
+    s->mean = sum / (float)n;
+}
+
+static float lk_rewrite_h_scalar(uint16_t* x, int n, int fmt, const AM_FieldXform* t) {
+    const float a = t->a, b = t->b, xmax = t->xmax;
+    const float r_top = t->r_top, near = t->near, r2 = t->r2;
+    float mx = -INFINITY;
+    for (int i = 0; i < n; i++) {
+        float v = half_get(x, i, fmt);
+        float y = a * v + b;
+        float band = (y >= near) ? r2 : 0.0f;
+        y -= (v >= xmax) ? r_top : band;
+        x[i] = half_put(y, fmt);
+        if (y > mx) mx = y;
+    }
+    return mx;
+}
+
+// Half-row tail: widen, reduce with the fp32 merge, as the SIMD float kernels do
+__attribute__((unused))
+static void lk_stats_h_merge(const float* lm, const float* l2, int lanes, float sum,
+                             const uint16_t* x, int i, int n, int fmt,
+                             AM_LogitStats* s) {
+    float mx = -INFINITY, sec = -1e30f;
+    for (int l = 0; l < lanes; l++) {
+        top2_push(lm[l], &mx, &sec);
+        top2_push(l2[l], &mx, &sec);
+    }
+    for (; i < n; i++) {
+        float v = half_get(x, i, fmt);
+        sum += v;
+        top2_push(v, &mx, &sec);
+    }
+    s->max = mx;
+    s->second = sec;
+    s->mean = sum / (float)n;
+}
+
+// ── delta voice: out += alpha * A @ t ──────────────────────────────────────
+// A is out_dim x rank, row-major. Every level specialises the row kernel for
+// ranks 4/8/16/32/64 (inlined with a constant rank, the inner loop unrolls
+// into registers) and keeps a runtime-rank path for the rest.
+
+static float lk_dot_scalar(const float* a, const float* b, int n) {
+    float sum = 0.0f;
+    for (int i = 0; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+// y += a * x (mul then add, so every level rounds alike)
+static void lk_axpy_scalar(float* y, const float* x, float a, int n) {
+    for (int i = 0; i < n; i++) y[i] += a * x[i];
+}
+
+// Four rows side by side; each row sums in rank order.
+static inline __attribute__((always_inline))
+void delta_rows_scalar(float* out, const float* A, const float* t, int n,
+                       int R, float alpha) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float* a = A + (size_t)i * R;
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        for (int r = 0; r < R; r++) {
+            s0 += a[r] * t[r];
+            s1 += a[R + r] * t[r];
+            s2 += a[2 * R + r] * t[r];
+            s3 += a[3 * R + r] * t[r];
+        }
+        out[i] += alpha * s0;
+        out[i + 1] += alpha * s1;
+        out[i + 2] += alpha * s2;
+        out[i + 3] += alpha * s3;
+    }
+    for (; i < n; i++) {
+        const float* a = A + (size_t)i * R;
+        float sum = 0.0f;
+        for (int r = 0; r < R; r++) sum += a[r] * t[r];
+        out[i] += alpha * sum;
+    }
+}
+
+static void lk_delta_scalar(float* out, const float* A, const float* t, int n,
+                            int rank, float alpha) {
+    switch (rank) {
+    case 4:  delta_rows_scalar(out, A, t, n, 4, alpha); break;
+    case 8:  delta_rows_scalar(out, A, t, n, 8, alpha); break;
+    case 16: delta_rows_scalar(out, A, t, n, 16, alpha); break;
+    case 32: delta_rows_scalar(out, A, t, n, 32, alpha); break;
+    case 64: delta_rows_scalar(out, A, t, n, 64, alpha); break;
+    default: delta_rows_scalar(out, A, t, n, rank, alpha); break;
+    }
+}
+
+// Quantized storage: dst[i] = q[i] * scale[i / group], n a whole number of
+// groups. int4 packs two's-complement nibbles, low nibble first; q points at
+// the byte holding element 0.
+static inline float nib_s4(const uint8_t* q, int i) {
+    int v = (i & 1) ? (q[i >> 1] >> 4) : (q[i >> 1] & 15);
+    return (float)((v ^ 8) - 8);
+}
+
+static void lk_deq_i8_scalar(const int8_t* q, int n, const float* scale, int group,
+                             float* dst) {
+    for (int g = 0; g < n; g += group, scale++)
+        for (int i = g; i < g + group; i++) dst[i] = (float)q[i] * *scale;
+}
+
+static void lk_deq_i4_scalar(const uint8_t* q, int n, const float* scale, int group,
+                             float* dst) {
+    for (int g = 0; g < n; g += group, scale++)
+        for (int i = g; i < g + group; i++) dst[i] = nib_s4(q, i) * *scale;
+}
+
+// Counter-based uniforms: out[i] = hash(key, c0 + i) as 24 bits in [0, 1).
+// Two murmur3 finalizer rounds keyed by k0 / k1; only 32-bit multiplies and
+// shifts, so every level vectorizes it and rounds it alike.
+static inline uint32_t rng_mix32(uint32_t h) {
+    h ^= h >> 16; h *= 0x85EBCA6Bu;
+    h ^= h >> 13; h *= 0xC2B2AE35u;
+    return h ^ (h >> 16);
+}
+
+static void lk_rng_scalar(float* out, int n, uint32_t k0, uint32_t k1, uint32_t c0) {
+    for (int i = 0; i < n; i++) {
+        uint32_t h = rng_mix32(rng_mix32((c0 + (uint32_t)i) * 0x9E3779B9u + k0) ^ k1);
+        out[i] = (float)(h >> 8) * (1.0f / 16777216.0f);
+    }
+}
+
+// ── AVX2 / AVX-512 kernels (x86, selected by cpuid) ─────────────────────────
+// Affine uses mul+add, not FMA: elementwise output is identical on every
+// level, only the reduction order of the mean differs.
+
+#ifdef AM_HAVE_X86
+
+#define AM_TARGET_AVX2   __attribute__((target("avx2,f16c")))
+// avx512f implies FMA, and GCC would contract mul+add into it: keep it off.
+#if defined(__clang__)
+#define AM_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define AM_TARGET_AVX512 __attribute__((target("avx512f"), optimize("fp-contract=off")))
+#endif
+
+AM_TARGET_AVX2
+static float hsum256(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+AM_TARGET_AVX2
+static float lk_sum_avx2(const float* x, int n) {
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_ps(s0, _mm256_loadu_ps(x + i));
+        s1 = _mm256_add_ps(s1, _mm256_loadu_ps(x + i + 8));
+    }
+    for (; i + 8 <= n; i += 8) s0 = _mm256_add_ps(s0, _mm256_loadu_ps(x + i));
+    float sum = hsum256(_mm256_add_ps(s0, s1));
+    for (; i < n; i++) sum += x[i];
+    return sum;
+}
+
+AM_TARGET_AVX2
+static float lk_max_avx2(const float* x, int n) {
+    __m256 m = _mm256_set1_ps(-INFINITY);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) m = _mm256_max_ps(m, _mm256_loadu_ps(x + i));
+    float lm[8];
+    _mm256_storeu_ps(lm, m);
+    float mx = x[0];
+    for (int l = 0; l < 8; l++) if (lm[l] > mx) mx = lm[l];
+    for (; i < n; i++) if (x[i] > mx) mx = x[i];
+    return mx;
+}
+
+AM_TARGET_AVX2
+static void lk_stats_avx2(const float* x, int n, AM_LogitStats* s) {
+    __m256 vs = _mm256_setzero_ps();
+    __m256 vm = _mm256_set1_ps(-INFINITY);
+    __m256 v2 = _mm256_set1_ps(-1e30f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        vs = _mm256_add_ps(vs, v);
+        v2 = _mm256_max_ps(v2, _mm256_min_ps(vm, v));
+        vm = _mm256_max_ps(vm, v);
+    }
+    float lm[8], l2[8];
+    _mm256_storeu_ps(lm, vm);
+    _mm256_storeu_ps(l2, v2);
+    lk_stats_merge(lm, l2, 8, hsum256(vs), x, i, n, s);
+}
+
+AM_TARGET_AVX2
+static void lk_affine_avx2(float* x, int n, float a, float b) {
+    const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_mul_ps(va, _mm256_loadu_ps(x + i)), vb));
+    for (; i < n; i++) x[i] = a * x[i] + b;
+}
+
+AM_TARGET_AVX2
+static float hmax256(__m256 v, float tail) {
+    float l[8];
+    _mm256_storeu_ps(l, v);
+    for (int i = 0; i < 8; i++) if (l[i] > tail) tail = l[i];
+    return tail;
+}
+
+AM_TARGET_AVX2
+static float lk_rewrite_avx2(float* x, int n, const AM_FieldXform* t) {
+    const __m256 va = _mm256_set1_ps(t->a), vb = _mm256_set1_ps(t->b);
+    const __m256 vxmax = _mm256_set1_ps(t->xmax), vnear = _mm256_set1_ps(t->near);
+    const __m256 vtop = _mm256_set1_ps(t->r_top), vr2 = _mm256_set1_ps(t->r2);
+    __m256 vmx = _mm256_set1_ps(-INFINITY);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 y = _mm256_add_ps(_mm256_mul_ps(va, v), vb);
+        __m256 band = _mm256_and_ps(_mm256_cmp_ps(y, vnear, _CMP_GE_OQ), vr2);
+        __m256 red = _mm256_blendv_ps(band, vtop, _mm256_cmp_ps(v, vxmax, _CMP_GE_OQ));
+        y = _mm256_sub_ps(y, red);
+        _mm256_storeu_ps(x + i, y);
+        vmx = _mm256_max_ps(vmx, y);
+    }
+    return hmax256(vmx, lk_rewrite_scalar(x + i, n - i, t));
+}
+
+// exp(x) = 2^k · p(r), r = x - k·ln2, |r| <= ln2/2; degree-6 polynomial,
+// ~2 ulp. Inputs below -87.3 (including -inf masks) give exactly 0.
+AM_TARGET_AVX2
+static inline __m256 exp256(__m256 x) {
+    const __m256 lo = _mm256_set1_ps(-87.3f);
+    __m256 dead = _mm256_cmp_ps(x, lo, _CMP_LT_OQ);
+    x = _mm256_min_ps(_mm256_max_ps(x, lo), _mm256_set1_ps(88.3f));
+    __m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504f)),
+                               _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(0.693359375f)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(-2.12194440e-4f)));
+    __m256 p = _mm256_set1_ps(1.0f / 720.0f);
+    p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(1.0f / 120.0f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(1.0f / 24.0f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(1.0f / 6.0f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, r), _mm256_set1_ps(0.5f));
+    p = _mm256_add_ps(_mm256_mul_ps(p, _mm256_mul_ps(r, r)), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+    __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(k), _mm256_set1_epi32(127)), 23);
+    return _mm256_andnot_ps(dead, _mm256_mul_ps(p, _mm256_castsi256_ps(e)));
+}
+
+AM_TARGET_AVX2
+static float lk_rewrite_exp_avx2(float* x, int n, const AM_FieldXform* t,
+                                 float m, float inv_t, float* w, float* bmax) {
+    const __m256 va = _mm256_set1_ps(t->a), vb = _mm256_set1_ps(t->b);
+    const __m256 vxmax = _mm256_set1_ps(t->xmax), vnear = _mm256_set1_ps(t->near);
+    const __m256 vtop = _mm256_set1_ps(t->r_top), vr2 = _mm256_set1_ps(t->r2);
+    const __m256 vm = _mm256_set1_ps(m), vit = _mm256_set1_ps(inv_t);
+    __m256 vs = _mm256_setzero_ps(), vmx = _mm256_set1_ps(-INFINITY);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 y = _mm256_add_ps(_mm256_mul_ps(va, v), vb);
+        __m256 band = _mm256_and_ps(_mm256_cmp_ps(y, vnear, _CMP_GE_OQ), vr2);
+        __m256 red = _mm256_blendv_ps(band, vtop, _mm256_cmp_ps(v, vxmax, _CMP_GE_OQ));
+        y = _mm256_sub_ps(y, red);
+        _mm256_storeu_ps(x + i, y);
+        __m256 e = exp256(_mm256_mul_ps(_mm256_sub_ps(y, vm), vit));
+        _mm256_storeu_ps(w + i, e);
+        vs = _mm256_add_ps(vs, e);
+        vmx = _mm256_max_ps(vmx, y);
+    }
+    float tail_max;
+    float sum = hsum256(vs) + lk_rewrite_exp_scalar(x + i, n - i, t, m, inv_t, w + i, &tail_max);
+    *bmax = hmax256(vmx, tail_max);
+    return sum;
+}
+
+// bf16 widens by a 16-bit shift; fp16 goes through F16C.
+AM_TARGET_AVX2
+static inline __m256 ld8_h(const uint16_t* p, int fmt) {
+    __m128i h = _mm_loadu_si128((const __m128i*)p);
+    if (fmt == LF_FP16) return _mm256_cvtph_ps(h);
+    return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16));
+}
+
+AM_TARGET_AVX2
+static inline void st8_h(uint16_t* p, __m256 v, int fmt) {
+    __m128i h;
+    if (fmt == LF_FP16) {
+        h = _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+    } else {
+        __m256i u = _mm256_castps_si256(v);
+        __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(u, 16), _mm256_set1_epi32(1));
+        u = _mm256_add_epi32(u, _mm256_add_epi32(_mm256_set1_epi32(0x7FFF), lsb));
+        u = _mm256_srli_epi32(u, 16);
+        h = _mm_packus_epi32(_mm256_castsi256_si128(u), _mm256_extracti128_si256(u, 1));
+    }
+    _mm_storeu_si128((__m128i*)p, h);
+}
+
+AM_TARGET_AVX2
+static void lk_stats_h_avx2(const uint16_t* x, int n, int fmt, AM_LogitStats* s) {
+    __m256 vs = _mm256_setzero_ps();
+    __m256 vm = _mm256_set1_ps(-INFINITY);
+    __m256 v2 = _mm256_set1_ps(-1e30f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = ld8_h(x + i, fmt);
+        vs = _mm256_add_ps(vs, v);
+        v2 = _mm256_max_ps(v2, _mm256_min_ps(vm, v));
+        vm = _mm256_max_ps(vm, v);
+    }
+    float lm[8], l2[8];
+    _mm256_storeu_ps(lm, vm);
+    _mm256_storeu_ps(l2, v2);
+    lk_stats_h_merge(lm, l2, 8, hsum256(vs), x, i, n, fmt, s);
+}
+
+AM_TARGET_AVX2
+static float lk_rewrite_h_avx2(uint16_t* x, int n, int fmt, const AM_FieldXform* t) {
+    const __m256 va = _mm256_set1_ps(t->a), vb = _mm256_set1_ps(t->b);
+    const __m256 vxmax = _mm256_set1_ps(t->xmax), vnear = _mm256_set1_ps(t->near);
+    const __m256 vtop = _mm256_set1_ps(t->r_top), vr2 = _mm256_set1_ps(t->r2);
+    __m256 vmx = _mm256_set1_ps(-INFINITY);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = ld8_h(x + i, fmt);
+        __m256 y = _mm256_add_ps(_mm256_mul_ps(va, v), vb);
+        __m256 band = _mm256_and_ps(_mm256_cmp_ps(y, vnear, _CMP_GE_OQ), vr2);
+        __m256 red = _mm256_blendv_ps(band, vtop, _mm256_cmp_ps(v, vxmax, _CMP_GE_OQ));
+        y = _mm256_sub_ps(y, red);
+        st8_h(x + i, y, fmt);
+        vmx = _mm256_max_ps(vmx, y);
+    }
+    return hmax256(vmx, lk_rewrite_h_scalar(x + i, n - i, fmt, t));
+}
+
+AM_TARGET_AVX2
+static float lk_dot_avx2(const float* a, const float* b, int n) {
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8),
+                                             _mm256_loadu_ps(b + i + 8)));
+    }
+    for (; i + 8 <= n; i += 8)
+        s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    float sum = hsum256(_mm256_add_ps(s0, s1));
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+AM_TARGET_AVX2
+static void lk_axpy_avx2(float* y, const float* x, float a, int n) {
+    const __m256 va = _mm256_set1_ps(a);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i),
+                                              _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+    for (; i < n; i++) y[i] += a * x[i];
+}
+
+// Horizontal sums of eight vectors, lane j = sum of v[j]
+AM_TARGET_AVX2
+static inline __m256 hsum8x8(const __m256* v) {
+    __m256 t0 = _mm256_hadd_ps(_mm256_hadd_ps(v[0], v[1]), _mm256_hadd_ps(v[2], v[3]));
+    __m256 t1 = _mm256_hadd_ps(_mm256_hadd_ps(v[4], v[5]), _mm256_hadd_ps(v[6], v[7]));
+    return _mm256_add_ps(_mm256_permute2f128_ps(t0, t1, 0x20),
+                         _mm256_permute2f128_ps(t0, t1, 0x31));
+}
+
+// out[i..i+7] += alpha * s
+AM_TARGET_AVX2
+static inline void delta_store8(float* out, __m256 s, __m256 va) {
+    _mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out), _mm256_mul_ps(va, s)));
+}
+
+// Rank a multiple of 8: eight rows per block, one accumulator each.
+AM_TARGET_AVX2 static inline __attribute__((always_inline))
+void delta_rows8_avx2(float* out, const float* A, const float* t, int n,
+                      int R, float alpha) {
+    const __m256 va = _mm256_set1_ps(alpha);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float* a = A + (size_t)i * R;
+        __m256 acc[8];
+        for (int j = 0; j < 8; j++) acc[j] = _mm256_setzero_ps();
+        for (int r = 0; r < R; r += 8) {
+            __m256 tv = _mm256_loadu_ps(t + r);
+            for (int j = 0; j < 8; j++)
+                acc[j] = _mm256_add_ps(acc[j], _mm256_mul_ps(_mm256_loadu_ps(a + j * R + r), tv));
+        }
+        delta_store8(out + i, hsum8x8(acc), va);
+    }
+    delta_rows_scalar(out + i, A + (size_t)i * R, t, n - i, R, alpha);
+}
+
+// Rank 4: two rows per vector, eight rows per block.
+AM_TARGET_AVX2
+static void delta_rows4_avx2(float* out, const float* A, const float* t, int n,
+                             float alpha) {
+    const __m256 va = _mm256_set1_ps(alpha);
+    const __m256 tv = _mm256_broadcast_ps((const __m128*)t);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float* a = A + (size_t)i * 4;
+        __m256 p0 = _mm256_mul_ps(_mm256_loadu_ps(a), tv);
+        __m256 p1 = _mm256_mul_ps(_mm256_loadu_ps(a + 8), tv);
+        __m256 p2 = _mm256_mul_ps(_mm256_loadu_ps(a + 16), tv);
+        __m256 p3 = _mm256_mul_ps(_mm256_loadu_ps(a + 24), tv);
+        // lanes come out as rows 0 2 4 6 | 1 3 5 7
+        __m256 s = _mm256_hadd_ps(_mm256_hadd_ps(p0, p1), _mm256_hadd_ps(p2, p3));
+        delta_store8(out + i, _mm256_permutevar8x32_ps(s, order), va);
+    }
+    delta_rows_scalar(out + i, A + (size_t)i * 4, t, n - i, 4, alpha);
+}
+
+AM_TARGET_AVX2
+static void lk_delta_avx2(float* out, const float* A, const float* t, int n,
+                          int rank, float alpha) {
+    switch (rank) {
+    case 4:  delta_rows4_avx2(out, A, t, n, alpha); break;
+    case 8:  delta_rows8_avx2(out, A, t, n, 8, alpha); break;
+    case 16: delta_rows8_avx2(out, A, t, n, 16, alpha); break;
+    case 32: delta_rows8_avx2(out, A, t, n, 32, alpha); break;
+    case 64: delta_rows8_avx2(out, A, t, n, 64, alpha); break;
+    default:
+        if (rank % 8 == 0) delta_rows8_avx2(out, A, t, n, rank, alpha);
+        else lk_delta_scalar(out, A, t, n, rank, alpha);
+        break;
+    }
+}
+
+// Scales for eight lanes starting at a group boundary: one broadcast when the
+// group spans the register, else lane k takes sc[k / group] (group | 8). The
+// masked load reads only the 8 / group scales that exist.
+typedef struct { __m256i idx, mask; } AM_DeqLanes;
+
+AM_TARGET_AVX2
+static inline __m256 deq_scale8(const float* sc, int group, const AM_DeqLanes* l) {
+    if (group >= 8) return _mm256_set1_ps(sc[0]);
+    return _mm256_permutevar8x32_ps(_mm256_maskload_ps(sc, l->mask), l->idx);
+}
+
+AM_TARGET_AVX2
+static inline AM_DeqLanes deq_lane_groups(int group) {
+    int ix[8], mk[8];
+    for (int k = 0; k < 8; k++) {
+        ix[k] = (group < 8) ? k / group : 0;
+        mk[k] = (group < 8 && k < 8 / group) ? -1 : 0;
+    }
+    AM_DeqLanes l = { _mm256_loadu_si256((const __m256i*)ix),
+                      _mm256_loadu_si256((const __m256i*)mk) };
+    return l;
+}
+
+AM_TARGET_AVX2
+static void lk_deq_i8_avx2(const int8_t* q, int n, const float* scale, int group,
+                           float* dst) {
+    if (group % 8 && 8 % group) { lk_deq_i8_scalar(q, n, scale, group, dst); return; }
+    const AM_DeqLanes lanes = deq_lane_groups(group);
+    const int step = (group < 8) ? 8 / group : 0;    // scales per vector
+    const int per = (group < 8) ? 1 : group / 8;      // vectors per scale
+    const float* sc = scale;
+    int i = 0, k = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 vs = deq_scale8(sc, group, &lanes);
+        __m256i v = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(q + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), vs));
+        if (step) sc += step;
+        else if (++k == per) { k = 0; sc++; }
+    }
+    for (; i < n; i++) dst[i] = (float)q[i] * scale[i / group];
+}
+
+// 16 nibbles (8 bytes) -> 16 sign-extended bytes in element order
+AM_TARGET_AVX2
+static inline __m128i unpack_s4x16(const uint8_t* q) {
+    const __m128i lo4 = _mm_set1_epi8(0x0F), eight = _mm_set1_epi8(8);
+    __m128i b = _mm_loadl_epi64((const __m128i*)q);
+    __m128i v = _mm_unpacklo_epi8(_mm_and_si128(b, lo4),
+                                  _mm_and_si128(_mm_srli_epi16(b, 4), lo4));
+    return _mm_sub_epi8(_mm_xor_si128(v, eight), eight);
+}
+
+AM_TARGET_AVX2
+static void lk_deq_i4_avx2(const uint8_t* q, int n, const float* scale, int group,
+                           float* dst) {
+    if (group % 8 && 8 % group) { lk_deq_i4_scalar(q, n, scale, group, dst); return; }
+    const AM_DeqLanes lanes = deq_lane_groups(group);
+    const int step = (group < 8) ? 8 / group : 0;
+    const int per = (group < 8) ? 1 : group / 8;
+    const float* sc = scale;
+    int i = 0, k = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = unpack_s4x16(q + (i >> 1));
+        for (int h = 0; h < 2; h++) {
+            __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(h ? _mm_srli_si128(v, 8) : v));
+            _mm256_storeu_ps(dst + i + 8 * h, _mm256_mul_ps(f, deq_scale8(sc, group, &lanes)));
+            if (step) sc += step;
+            else if (++k == per) { k = 0; sc++; }
+        }
+    }
+    for (; i < n; i++) dst[i] = nib_s4(q, i) * scale[i / group];
+}
+
+AM_TARGET_AVX2
+static inline __m256i rng_mix8(__m256i h) {
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32((int)0x85EBCA6Bu));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32((int)0xC2B2AE35u));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+}
+
+AM_TARGET_AVX2
+static void lk_rng_avx2(float* out, int n, uint32_t k0, uint32_t k1, uint32_t c0) {
+    const __m256i gold = _mm256_set1_epi32((int)0x9E3779B9u);
+    const __m256i v0 = _mm256_set1_epi32((int)k0), v1 = _mm256_set1_epi32((int)k1);
+    const __m256 unit = _mm256_set1_ps(1.0f / 16777216.0f);
+    __m256i c = _mm256_add_epi32(_mm256_set1_epi32((int)c0),
+                                 _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i h = _mm256_add_epi32(_mm256_mullo_epi32(c, gold), v0);
+        h = rng_mix8(_mm256_xor_si256(rng_mix8(h), v1));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8)), unit));
+        c = _mm256_add_epi32(c, _mm256_set1_epi32(8));
+    }
+    if (i < n) lk_rng_scalar(out + i, n - i, k0, k1, c0 + (uint32_t)i);
+}
+
+AM_TARGET_AVX512
+static float lk_sum_avx512(const float* x, int n) {
+    __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_add_ps(s0, _mm512_loadu_ps(x + i));
+        s1 = _mm512_add_ps(s1, _mm512_loadu_ps(x + i + 16));
+    }
+    for (; i + 16 <= n; i += 16) s0 = _mm512_add_ps(s0, _mm512_loadu_ps(x + i));
+    float sum = _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+    for (; i < n; i++) sum += x[i];
+    return sum;
+}
+
+AM_TARGET_AVX512
+static float lk_max_avx512(const float* x, int n) {
+    __m512 m = _mm512_set1_ps(-INFINITY);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) m = _mm512_max_ps(m, _mm512_loadu_ps(x + i));
+    float mx = _mm512_reduce_max_ps(m);
+    if (x[0] > mx) mx = x[0];
+    for (; i < n; i++) if (x[i] > mx) mx = x[i];
+    return mx;
+}
+
+AM_TARGET_AVX512
+static void lk_stats_avx512(const float* x, int n, AM_LogitStats* s) {
+    __m512 vs = _mm512_setzero_ps();
+    __m512 vm = _mm512_set1_ps(-INFINITY);
+    __m512 v2 = _mm512_set1_ps(-1e30f);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_loadu_ps(x + i);
+        vs = _mm512_add_ps(vs, v);
+        v2 = _mm512_max_ps(v2, _mm512_min_ps(vm, v));
+        vm = _mm512_max_ps(vm, v);
+    }
+    float lm[16], l2[16];
+    _mm512_storeu_ps(lm, vm);
+    _mm512_storeu_ps(l2, v2);
+    lk_stats_merge(lm, l2, 16, _mm512_reduce_add_ps(vs), x, i, n, s);
+}
+
+AM_TARGET_AVX512
+static void lk_affine_avx512(float* x, int n, float a, float b) {
+    const __m512 va = _mm512_set1_ps(a), vb = _mm512_set1_ps(b);
+    int i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(x + i, _mm512_add_ps(_mm512_mul_ps(va, _mm512_loadu_ps(x + i)), vb));
+    for (; i < n; i++) x[i] = a * x[i] + b;
+}
+
+AM_TARGET_AVX512
+static float lk_rewrite_avx512(float* x, int n, const AM_FieldXform* t) {
+    const __m512 va = _mm512_set1_ps(t->a), vb = _mm512_set1_ps(t->b);
+    const __m512 vxmax = _mm512_set1_ps(t->xmax), vnear = _mm512_set1_ps(t->near);
+    const __m512 vtop = _mm512_set1_ps(t->r_top), vr2 = _mm512_set1_ps(t->r2);
+    const __m512 zero = _mm512_setzero_ps();
+    __m512 vmx = _mm512_set1_ps(-INFINITY);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_loadu_ps(x + i);
+        __m512 y = _mm512_add_ps(_mm512_mul_ps(va, v), vb);
+        __m512 red = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(y, vnear, _CMP_GE_OQ), zero, vr2);
+        red = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(v, vxmax, _CMP_GE_OQ), red, vtop);
+        y = _mm512_sub_ps(y, red);
+        _mm512_storeu_ps(x + i, y);
+        vmx = _mm512_max_ps(vmx, y);
+    }
+    return fmaxf(_mm512_reduce_max_ps(vmx), lk_rewrite_scalar(x + i, n - i, t));
+}
+
+AM_TARGET_AVX512
+static inline __m512 exp512(__m512 x) {
+    const __m512 lo = _mm512_set1_ps(-87.3f);
+    __mmask16 live = _mm512_cmp_ps_mask(x, lo, _CMP_GE_OQ);
+    x = _mm512_min_ps(_mm512_max_ps(x, lo), _mm512_set1_ps(88.3f));
+    __m512 k = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(1.44269504f)),
+                                    _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512 r = _mm512_sub_ps(x, _mm512_mul_ps(k, _mm512_set1_ps(0.693359375f)));
+    r = _mm512_sub_ps(r, _mm512_mul_ps(k, _mm512_set1_ps(-2.12194440e-4f)));
+    __m512 p = _mm512_set1_ps(1.0f / 720.0f);
+    p = _mm512_add_ps(_mm512_mul_ps(p, r), _mm512_set1_ps(1.0f / 120.0f));
+    p = _mm512_add_ps(_mm512_mul_ps(p, r), _mm512_set1_ps(1.0f / 24.0f));
+    p = _mm512_add_ps(_mm512_mul_ps(p, r), _mm512_set1_ps(1.0f / 6.0f));
+    p = _mm512_add_ps(_mm512_mul_ps(p, r), _mm512_set1_ps(0.5f));
+    p = _mm512_add_ps(_mm512_mul_ps(p, _mm512_mul_ps(r, r)), _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+    __m512i e = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(k), _mm512_set1_epi32(127)), 23);
+    return _mm512_maskz_mul_ps(live, p, _mm512_castsi512_ps(e));
+}
+
+AM_TARGET_AVX512
+static float lk_rewrite_exp_avx512(float* x, int n, const AM_FieldXform* t,
+                                   float m, float inv_t, float* w, float* bmax) {
+    const __m512 va = _mm512_set1_ps(t->a), vb = _mm512_set1_ps(t->b);
+    const __m512 vxmax = _mm512_set1_ps(t->xmax), vnear = _mm512_set1_ps(t->near);
+    const __m512 vtop = _mm512_set1_ps(t->r_top), vr2 = _mm512_set1_ps(t->r2);
+    const __m512 vm = _mm512_set1_ps(m), vit = _mm512_set1_ps(inv_t);
+    const __m512 zero = _mm512_setzero_ps();
+    __m512 vs = zero, vmx = _mm512_set1_ps(-INFINITY);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_loadu_ps(x + i);
+        __m512 y = _mm512_add_ps(_mm512_mul_ps(va, v), vb);
+        __m512 red = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(y, vnear, _CMP_GE_OQ), zero, vr2);
+        red = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(v, vxmax, _CMP_GE_OQ), red, vtop);
+        y = _mm512_sub_ps(y, red);
+        _mm512_storeu_ps(x + i, y);
+        __m512 e = exp512(_mm512_mul_ps(_mm512_sub_ps(y, vm), vit));
+        _mm512_storeu_ps(w + i, e);
+        vs = _mm512_add_ps(vs, e);
+        vmx = _mm512_max_ps(vmx, y);
+    }
+    float tail_max;
+    float sum = _mm512_reduce_add_ps(vs) +
+                lk_rewrite_exp_scalar(x + i, n - i, t, m, inv_t, w + i, &tail_max);
+    float vmax = _mm512_reduce_max_ps(vmx);
+    *bmax = (vmax > tail_max) ? vmax : tail_max;
+    return sum;
+}
+
+AM_TARGET_AVX512
+static inline __m512 ld16_h(const uint16_t* p, int fmt) {
+    __m256i h = _mm256_loadu_si256((const __m256i*)p);
+    if (fmt == LF_FP16) return _mm512_cvtph_ps(h);
+    return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(h), 16));
+}
+
+AM_TARGET_AVX512
+static inline void st16_h(uint16_t* p, __m512 v, int fmt) {
+    __m256i h;
+    if (fmt == LF_FP16) {
+        h = _mm512_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+    } else {
+        __m512i u = _mm512_castps_si512(v);
+        __m512i lsb = _mm512_and_si512(_mm512_srli_epi32(u, 16), _mm512_set1_epi32(1));
+        u = _mm512_add_epi32(u, _mm512_add_epi32(_mm512_set1_epi32(0x7FFF), lsb));
+        h = _mm512_cvtepi32_epi16(_mm512_srli_epi32(u, 16));
+    }
+    _mm256_storeu_si256((__m256i*)p, h);
+}
+
+AM_TARGET_AVX512
+static void lk_stats_h_avx512(const uint16_t* x, int n, int fmt, AM_LogitStats* s) {
+    __m512 vs = _mm512_setzero_ps();
+    __m512 vm = _mm512_set1_ps(-INFINITY);
+    __m512 v2 = _mm512_set1_ps(-1e30f);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = ld16_h(x + i, fmt);
+        vs = _mm512_add_ps(vs, v);
+        v2 = _mm512_max_ps(v2, _mm512_min_ps(vm, v));
+        vm = _mm512_max_ps(vm, v);
+    }
+    float lm[16], l2[16];
+    _mm512_storeu_ps(lm, vm);
+    _mm512_storeu_ps(l2, v2);
+    lk_stats_h_merge(lm, l2, 16, _mm512_reduce_add_ps(vs), x, i, n, fmt, s);
+}
+
+AM_TARGET_AVX512
+static float lk_rewrite_h_avx512(uint16_t* x, int n, int fmt, const AM_FieldXform* t) {
+    const __m512 va = _mm512_set1_ps(t->a), vb = _mm512_set1_ps(t->b);
+    const __m512 vxmax = _mm512_set1_ps(t->xmax), vnear = _mm512_set1_ps(t->near);
+    const __m512 vtop = _mm512_set1_ps(t->r_top), vr2 = _mm512_set1_ps(t->r2);
+    const __m512 zero = _mm512_setzero_ps();
+    __m512 vmx = _mm512_set1_ps(-INFINITY);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = ld16_h(x + i, fmt);
+        __m512 y = _mm512_add_ps(_mm512_mul_ps(va, v), vb);
+        __m512 red = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(y, vnear, _CMP_GE_OQ), zero, vr2);
+        red = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(v, vxmax, _CMP_GE_OQ), red, vtop);
+        y = _mm512_sub_ps(y, red);
+        st16_h(x + i, y, fmt);
+        vmx = _mm512_max_ps(vmx, y);
+    }
+    return fmaxf(_mm512_reduce_max_ps(vmx), lk_rewrite_h_scalar(x + i, n - i, fmt, t));
+}
+
+AM_TARGET_AVX512
+static float lk_dot_avx512(const float* a, const float* b, int n) {
+    __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_add_ps(s0, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+        s1 = _mm512_add_ps(s1, _mm512_mul_ps(_mm512_loadu_ps(a + i + 16),
+                                             _mm512_loadu_ps(b + i + 16)));
+    }
+    for (; i + 16 <= n; i += 16)
+        s0 = _mm512_add_ps(s0, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+    float sum = _mm512_reduce_add_ps(_mm512_add_ps(s0, s1));
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+AM_TARGET_AVX512
+static void lk_axpy_avx512(float* y, const float* x, float a, int n) {
+    const __m512 va = _mm512_set1_ps(a);
+    int i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i),
+                                              _mm512_mul_ps(va, _mm512_loadu_ps(x + i))));
+    if (i < n) {
+        __mmask16 m = (__mmask16)((1u << (n - i)) - 1);
+        _mm512_mask_storeu_ps(y + i, m, _mm512_add_ps(_mm512_maskz_loadu_ps(m, y + i),
+                              _mm512_mul_ps(va, _mm512_maskz_loadu_ps(m, x + i))));
+    }
+}
+
+// Rank a multiple of 16: eight rows per block, folded to 256 bits for the
+// eight-way horizontal sum.
+AM_TARGET_AVX512 static inline __attribute__((always_inline))
+void delta_rows16_avx512(float* out, const float* A, const float* t, int n,
+                         int R, float alpha) {
+    const __m256 va = _mm256_set1_ps(alpha);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float* a = A + (size_t)i * R;
+        __m512 acc[8];
+        __m256 half[8];
+        for (int j = 0; j < 8; j++) acc[j] = _mm512_setzero_ps();
+        for (int r = 0; r < R; r += 16) {
+            __m512 tv = _mm512_loadu_ps(t + r);
+            for (int j = 0; j < 8; j++)
+                acc[j] = _mm512_add_ps(acc[j], _mm512_mul_ps(_mm512_loadu_ps(a + j * R + r), tv));
+        }
+        for (int j = 0; j < 8; j++)
+            half[j] = _mm256_add_ps(_mm512_castps512_ps256(acc[j]),
+                                    _mm256_castpd_ps(_mm512_extractf64x4_pd(
+                                        _mm512_castps_pd(acc[j]), 1)));
+        delta_store8(out + i, hsum8x8(half), va);
+    }
+    delta_rows_scalar(out + i, A + (size_t)i * R, t, n - i, R, alpha);
+}
+
+// Ranks 4 and 8 fit a 256-bit row already: those run the AVX2 kernels.
+AM_TARGET_AVX512
+static void lk_delta_avx512(float* out, const float* A, const float* t, int n,
+                            int rank, float alpha) {
+    switch (rank) {
+    case 16: delta_rows16_avx512(out, A, t, n, 16, alpha); break;
+    case 32: delta_rows16_avx512(out, A, t, n, 32, alpha); break;
+    case 64: delta_rows16_avx512(out, A, t, n, 64, alpha); break;
+    default:
+        if (rank % 16 == 0) delta_rows16_avx512(out, A, t, n, rank, alpha);
+        else lk_delta_avx2(out, A, t, n, rank, alpha);
+        break;
+    }
+}
+
+// Sixteen lanes from a group boundary: broadcast, or lane k takes
+// sc[k / group] when group | 16 (masked load of the 16 / group scales).
+AM_TARGET_AVX512
+static inline __m512 deq_scale16(const float* sc, int group, __m512i idx) {
+    if (group >= 16) return _mm512_set1_ps(sc[0]);
+    __mmask16 m = (__mmask16)((1u << (16 / group)) - 1);
+    return _mm512_permutexvar_ps(idx, _mm512_maskz_loadu_ps(m, sc));
+}
+
+AM_TARGET_AVX512
+static inline __m512i deq_lane_groups16(int group) {
+    int ix[16];
+    for (int k = 0; k < 16; k++) ix[k] = (group < 16) ? k / group : 0;
+    return _mm512_loadu_si512(ix);
+}
+
+AM_TARGET_AVX512
+static void lk_deq_i8_avx512(const int8_t* q, int n, const float* scale, int group,
+                             float* dst) {
+    if (group % 16 && 16 % group) { lk_deq_i8_avx2(q, n, scale, group, dst); return; }
+    const __m512i idx = deq_lane_groups16(group);
+    const int step = (group < 16) ? 16 / group : 0;
+    const int per = (group < 16) ? 1 : group / 16;
+    const float* sc = scale;
+    int i = 0, k = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_cvtepi8_epi32(_mm_loadu_si128((const __m128i*)(q + i)));
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v),
+                                                deq_scale16(sc, group, idx)));
+        if (step) sc += step;
+        else if (++k == per) { k = 0; sc++; }
+    }
+    for (; i < n; i++) dst[i] = (float)q[i] * scale[i / group];
+}
+
+AM_TARGET_AVX512
+static void lk_deq_i4_avx512(const uint8_t* q, int n, const float* scale, int group,
+                             float* dst) {
+    if (group % 16 && 16 % group) { lk_deq_i4_avx2(q, n, scale, group, dst); return; }
+    const __m512i idx = deq_lane_groups16(group);
+    const int step = (group < 16) ? 16 / group : 0;
+    const int per = (group < 16) ? 1 : group / 16;
+    const float* sc = scale;
+    int i = 0, k = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_cvtepi8_epi32(unpack_s4x16(q + (i >> 1)));
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v),
+                                                deq_scale16(sc, group, idx)));
+        if (step) sc += step;
+        else if (++k == per) { k = 0; sc++; }
+    }
+    for (; i < n; i++) dst[i] = nib_s4(q, i) * scale[i / group];
+}
+
+AM_TARGET_AVX512
+static inline __m512i rng_mix16(__m512i h) {
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 16));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32((int)0x85EBCA6Bu));
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 13));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32((int)0xC2B2AE35u));
+    return _mm512_xor_si512(h, _mm512_srli_epi32(h, 16));
+}
+
+AM_TARGET_AVX512
+static void lk_rng_avx512(float* out, int n, uint32_t k0, uint32_t k1, uint32_t c0) {
+    const __m512i gold = _mm512_set1_epi32((int)0x9E3779B9u);
+    const __m512i v0 = _mm512_set1_epi32((int)k0), v1 = _mm512_set1_epi32((int)k1);
+    const __m512 unit = _mm512_set1_ps(1.0f / 16777216.0f);
+    __m512i c = _mm512_add_epi32(_mm512_set1_epi32((int)c0),
+                                 _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+                                                   8, 9, 10, 11, 12, 13, 14, 15));
+    for (int i = 0; i < n; i += 16) {
+        __mmask16 m = (n - i >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        __m512i h = _mm512_add_epi32(_mm512_mullo_epi32(c, gold), v0);
+        h = rng_mix16(_mm512_xor_si512(rng_mix16(h), v1));
+        _mm512_mask_storeu_ps(out + i, m,
+                              _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(h, 8)), unit));
+        c = _mm512_add_epi32(c, _mm512_set1_epi32(16));
+    }
+}
+
+#endif // AM_HAVE_X86
+
+// ── NEON kernels (aarch64: always present) ──────────────────────────────────
+
+#ifdef AM_HAVE_NEON
+
+static float lk_sum_neon(const float* x, int n) {
+    float32x4_t s0 = vdupq_n_f32(0.0f), s1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = vaddq_f32(s0, vld1q_f32(x + i));
+        s1 = vaddq_f32(s1, vld1q_f32(x + i + 4));
+    }
+    for (; i + 4 <= n; i += 4) s0 = vaddq_f32(s0, vld1q_f32(x + i));
+    float sum = vaddvq_f32(vaddq_f32(s0, s1));
+    for (; i < n; i++) sum += x[i];
+    return sum;
+}
+
+static float lk_max_neon(const float* x, int n) {
+    float32x4_t m = vdupq_n_f32(-INFINITY);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) m = vmaxq_f32(m, vld1q_f32(x + i));
+    float mx = vmaxvq_f32(m);
+    if (x[0] > mx) mx = x[0];
+    for (; i < n; i++) if (x[i] > mx) mx = x[i];
+    return mx;
+}
+
+static void lk_stats_neon(const float* x, int n, AM_LogitStats* s) {
+    float32x4_t vs = vdupq_n_f32(0.0f);
+    float32x4_t vm = vdupq_n_f32(-INFINITY);
+    float32x4_t v2 = vdupq_n_f32(-1e30f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(x + i);
+        vs = vaddq_f32(vs, v);
+        v2 = vmaxq_f32(v2, vminq_f32(vm, v));
+        vm = vmaxq_f32(vm, v);
+    }
+    float lm[4], l2[4];
+    vst1q_f32(lm, vm);
+    vst1q_f32(l2, v2);
+    lk_stats_merge(lm, l2, 4, vaddvq_f32(vs), x, i, n, s);
+}
+
+static void lk_affine_neon(float* x, int n, float a, float b) {
+    const float32x4_t va = vdupq_n_f32(a), vb = vdupq_n_f32(b);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(x + i, vaddq_f32(vmulq_f32(va, vld1q_f32(x + i)), vb));
+    for (; i < n; i++) x[i] = a * x[i] + b;
+}
+
+static float lk_rewrite_neon(float* x, int n, const AM_FieldXform* t) {
+    const float32x4_t va = vdupq_n_f32(t->a), vb = vdupq_n_f32(t->b);
+    const float32x4_t vxmax = vdupq_n_f32(t->xmax), vnear = vdupq_n_f32(t->near);
+    const float32x4_t vtop = vdupq_n_f32(t->r_top), vr2 = vdupq_n_f32(t->r2);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t vmx = vdupq_n_f32(-INFINITY);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(x + i);
+        float32x4_t y = vaddq_f32(vmulq_f32(va, v), vb);
+        float32x4_t red = vbslq_f32(vcgeq_f32(y, vnear), vr2, zero);
+        red = vbslq_f32(vcgeq_f32(v, vxmax), vtop, red);
+        y = vsubq_f32(y, red);
+        vst1q_f32(x + i, y);
+        vmx = vmaxq_f32(vmx, y);
+    }
+    return fmaxf(vmaxvq_f32(vmx), lk_rewrite_scalar(x + i, n - i, t));
+}
+
+static inline float32x4_t exp4(float32x4_t x) {
+    const float32x4_t lo = vdupq_n_f32(-87.3f);
+    uint32x4_t live = vcgeq_f32(x, lo);
+    x = vminq_f32(vmaxq_f32(x, lo), vdupq_n_f32(88.3f));
+    float32x4_t k = vrndnq_f32(vmulq_f32(x, vdupq_n_f32(1.44269504f)));
+    float32x4_t r = vsubq_f32(x, vmulq_f32(k, vdupq_n_f32(0.693359375f)));
+    r = vsubq_f32(r, vmulq_f32(k, vdupq_n_f32(-2.12194440e-4f)));
+    float32x4_t p = vdupq_n_f32(1.0f / 720.0f);
+    p = vaddq_f32(vmulq_f32(p, r), vdupq_n_f32(1.0f / 120.0f));
+    p = vaddq_f32(vmulq_f32(p, r), vdupq_n_f32(1.0f / 24.0f));
+    p = vaddq_f32(vmulq_f32(p, r), vdupq_n_f32(1.0f / 6.0f));
+    p = vaddq_f32(vmulq_f32(p, r), vdupq_n_f32(0.5f));
+    p = vaddq_f32(vmulq_f32(p, vmulq_f32(r, r)), vaddq_f32(r, vdupq_n_f32(1.0f)));
+    int32x4_t e = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(k), vdupq_n_s32(127)), 23);
+    float32x4_t res = vmulq_f32(p, vreinterpretq_f32_s32(e));
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(res), live));
+}
+
+static float lk_rewrite_exp_neon(float* x, int n, const AM_FieldXform* t,
+                                 float m, float inv_t, float* w, float* bmax) {
+    const float32x4_t va = vdupq_n_f32(t->a), vb = vdupq_n_f32(t->b);
+    const float32x4_t vxmax = vdupq_n_f32(t->xmax), vnear = vdupq_n_f32(t->near);
+    const float32x4_t vtop = vdupq_n_f32(t->r_top), vr2 = vdupq_n_f32(t->r2);
+    const float32x4_t vm = vdupq_n_f32(m), vit = vdupq_n_f32(inv_t);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t vs = zero, vmx = vdupq_n_f32(-INFINITY);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(x + i);
+        float32x4_t y = vaddq_f32(vmulq_f32(va, v), vb);
+        float32x4_t red = vbslq_f32(vcgeq_f32(y, vnear), vr2, zero);
+        red = vbslq_f32(vcgeq_f32(v, vxmax), vtop, red);
+        y = vsubq_f32(y, red);
+        vst1q_f32(x + i, y);
+        float32x4_t e = exp4(vmulq_f32(vsubq_f32(y, vm), vit));
+        vst1q_f32(w + i, e);
+        vs = vaddq_f32(vs, e);
+        vmx = vmaxq_f32(vmx, y);
+    }
+    float tail_max;
+    float sum = vaddvq_f32(vs) +
+                lk_rewrite_exp_scalar(x + i, n - i, t, m, inv_t, w + i, &tail_max);
+    float vmax = vmaxvq_f32(vmx);
+    *bmax = (vmax > tail_max) ? vmax : tail_max;
+    return sum;
+}
+
+static inline float32x4_t ld4_h(const uint16_t* p, int fmt) {
+    uint16x4_t h = vld1_u16(p);
+    if (fmt == LF_FP16) return vcvt_f32_f16(vreinterpret_f16_u16(h));
+    return vreinterpretq_f32_u32(vshll_n_u16(h, 16));
+}
+
+static inline void st4_h(uint16_t* p, float32x4_t v, int fmt) {
+    if (fmt == LF_FP16) {
+        vst1_u16(p, vreinterpret_u16_f16(vcvt_f16_f32(v)));
+        return;
+    }
+    uint32x4_t u = vreinterpretq_u32_f32(v);
+    uint32x4_t lsb = vandq_u32(vshrq_n_u32(u, 16), vdupq_n_u32(1));
+    u = vaddq_u32(u, vaddq_u32(vdupq_n_u32(0x7FFF), lsb));
+    vst1_u16(p, vshrn_n_u32(u, 16));
+}
+
+static void lk_stats_h_neon(const uint16_t* x, int n, int fmt, AM_LogitStats* s) {
+    float32x4_t vs = vdupq_n_f32(0.0f);
+    float32x4_t vm = vdupq_n_f32(-INFINITY);
+    float32x4_t v2 = vdupq_n_f32(-1e30f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = ld4_h(x + i, fmt);
+        vs = vaddq_f32(vs, v);
+        v2 = vmaxq_f32(v2, vminq_f32(vm, v));
+        vm = vmaxq_f32(vm, v);
+    }
+    float lm[4], l2[4];
+    vst1q_f32(lm, vm);
+    vst1q_f32(l2, v2);
+    lk_stats_h_merge(lm, l2, 4, vaddvq_f32(vs), x, i, n, fmt, s);
+}
+
+static float lk_rewrite_h_neon(uint16_t* x, int n, int fmt, const AM_FieldXform* t) {
+    const float32x4_t va = vdupq_n_f32(t->a), vb = vdupq_n_f32(t->b);
+    const float32x4_t vxmax = vdupq_n_f32(t->xmax), vnear = vdupq_n_f32(t->near);
+    const float32x4_t vtop = vdupq_n_f32(t->r_top), vr2 = vdupq_n_f32(t->r2);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t vmx = vdupq_n_f32(-INFINITY);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = ld4_h(x + i, fmt);
+        float32x4_t y = vaddq_f32(vmulq_f32(va, v), vb);
+        float32x4_t red = vbslq_f32(vcgeq_f32(y, vnear), vr2, zero);
+        red = vbslq_f32(vcgeq_f32(v, vxmax), vtop, red);
+        y = vsubq_f32(y, red);
+        st4_h(x + i, y, fmt);
+        vmx = vmaxq_f32(vmx, y);
+    }
+    return fmaxf(vmaxvq_f32(vmx), lk_rewrite_h_scalar(x + i, n - i, fmt, t));
+}
+
+static float lk_dot_neon(const float* a, const float* b, int n) {
+    float32x4_t s0 = vdupq_n_f32(0.0f), s1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = vaddq_f32(s0, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        s1 = vaddq_f32(s1, vmulq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4)));
+    }
+    for (; i + 4 <= n; i += 4)
+        s0 = vaddq_f32(s0, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    float sum = vaddvq_f32(vaddq_f32(s0, s1));
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+static void lk_axpy_neon(float* y, const float* x, float a, int n) {
+    const float32x4_t va = vdupq_n_f32(a);
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(y + i, vaddq_f32(vld1q_f32(y + i), vmulq_f32(va, vld1q_f32(x + i))));
+    for (; i < n; i++) y[i] += a * x[i];
+}
+
+// Rank a multiple of 4: four rows per block, pairwise-added to one vector.
+static inline __attribute__((always_inline))
+void delta_rows4_neon(float* out, const float* A, const float* t, int n,
+                      int R, float alpha) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float* a = A + (size_t)i * R;
+        float32x4_t acc[4];
+        for (int j = 0; j < 4; j++) acc[j] = vdupq_n_f32(0.0f);
+        for (int r = 0; r < R; r += 4) {
+            float32x4_t tv = vld1q_f32(t + r);
+            for (int j = 0; j < 4; j++)
+                acc[j] = vaddq_f32(acc[j], vmulq_f32(vld1q_f32(a + j * R + r), tv));
+        }
+        float32x4_t s = vpaddq_f32(vpaddq_f32(acc[0], acc[1]), vpaddq_f32(acc[2], acc[3]));
+        vst1q_f32(out + i, vaddq_f32(vld1q_f32(out + i), vmulq_n_f32(s, alpha)));
+    }
+    delta_rows_scalar(out + i, A + (size_t)i * R, t, n - i, R, alpha);
+}
+
+static void lk_delta_neon(float* out, const float* A, const float* t, int n,
+                          int rank, float alpha) {
+    switch (rank) {
+    case 4:  delta_rows4_neon(out, A, t, n, 4, alpha); break;
+    case 8:  delta_rows4_neon(out, A, t, n, 8, alpha); break;
+    case 16: delta_rows4_neon(out, A, t, n, 16, alpha); break;
+    case 32: delta_rows4_neon(out, A, t, n, 32, alpha); break;
+    case 64: delta_rows4_neon(out, A, t, n, 64, alpha); break;
+    default:
+        if (rank % 4 == 0) delta_rows4_neon(out, A, t, n, rank, alpha);
+        else lk_delta_scalar(out, A, t, n, rank, alpha);
+        break;
+    }
+}
+
+// Eight lanes from a group boundary as two quads: broadcast when the group
+// spans a quad, else lane k takes sc[k / group] (group 1 or 2).
+static inline void deq_s8x8_neon(int8x8_t v, const float* sc, int group, float* dst) {
+    int16x8_t w = vmovl_s8(v);
+    float32x4_t s0, s1;
+    if (group >= 8) s0 = s1 = vdupq_n_f32(sc[0]);
+    else if (group == 4) { s0 = vdupq_n_f32(sc[0]); s1 = vdupq_n_f32(sc[1]); }
+    else {
+        float sv[8];
+        for (int k = 0; k < 8; k++) sv[k] = sc[k / group];
+        s0 = vld1q_f32(sv);
+        s1 = vld1q_f32(sv + 4);
+    }
+    vst1q_f32(dst, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(w))), s0));
+    vst1q_f32(dst + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(w))), s1));
+}
+
+static void lk_deq_i8_neon(const int8_t* q, int n, const float* scale, int group,
+                           float* dst) {
+    if (group % 8 && 8 % group) { lk_deq_i8_scalar(q, n, scale, group, dst); return; }
+    const int step = (group < 8) ? 8 / group : 0;
+    const int per = (group < 8) ? 1 : group / 8;
+    const float* sc = scale;
+    int i = 0, k = 0;
+    for (; i + 8 <= n; i += 8) {
+        deq_s8x8_neon(vld1_s8(q + i), sc, group, dst + i);
+        if (step) sc += step;
+        else if (++k == per) { k = 0; sc++; }
+    }
+    for (; i < n; i++) dst[i] = (float)q[i] * scale[i / group];
+}
+
+static void lk_deq_i4_neon(const uint8_t* q, int n, const float* scale, int group,
+                           float* dst) {
+    if (group % 8 && 8 % group) { lk_deq_i4_scalar(q, n, scale, group, dst); return; }
+    const int step = (group < 8) ? 8 / group : 0;
+    const int per = (group < 8) ? 1 : group / 8;
+    const int8x8_t eight = vdup_n_s8(8);
+    const float* sc = scale;
+    int i = 0, k = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x8_t b = vld1_u8(q + (i >> 1));
+        uint8x8x2_t z = vzip_u8(vand_u8(b, vdup_n_u8(0x0F)), vshr_n_u8(b, 4));
+        for (int h = 0; h < 2; h++) {
+            int8x8_t v = vsub_s8(veor_s8(vreinterpret_s8_u8(z.val[h]), eight), eight);
+            deq_s8x8_neon(v, sc, group, dst + i + 8 * h);
+            if (step) sc += step;
+            else if (++k == per) { k = 0; sc++; }
+        }
+    }
+    for (; i < n; i++) dst[i] = nib_s4(q, i) * scale[i / group];
+}
+
+static inline uint32x4_t rng_mix4(uint32x4_t h) {
+    h = veorq_u32(h, vshrq_n_u32(h, 16));
+    h = vmulq_u32(h, vdupq_n_u32(0x85EBCA6Bu));
+    h = veorq_u32(h, vshrq_n_u32(h, 13));
+    h = vmulq_u32(h, vdupq_n_u32(0xC2B2AE35u));
+    return veorq_u32(h, vshrq_n_u32(h, 16));
+}
+
+static void lk_rng_neon(float* out, int n, uint32_t k0, uint32_t k1, uint32_t c0) {
+    static const uint32_t lane[4] = { 0, 1, 2, 3 };
+    const uint32x4_t gold = vdupq_n_u32(0x9E3779B9u);
+    const uint32x4_t v0 = vdupq_n_u32(k0), v1 = vdupq_n_u32(k1);
+    uint32x4_t c = vaddq_u32(vdupq_n_u32(c0), vld1q_u32(lane));
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t h = vaddq_u32(vmulq_u32(c, gold), v0);
+        h = rng_mix4(veorq_u32(rng_mix4(h), v1));
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(h, 8)), 1.0f / 16777216.0f));
+        c = vaddq_u32(c, vdupq_n_u32(4));
+    }
+    if (i < n) lk_rng_scalar(out + i, n - i, k0, k1, c0 + (uint32_t)i);
+}
+
+#endif // AM_HAVE_NEON
+
+// ── dispatch ────────────────────────────────────────────────────────────────
+
+typedef struct {
+    int         level;
+    const char* name;
+    float (*sum)(const float* x, int n);
+    float (*max)(const float* x, int n);
+    void  (*stats)(const float* x, int n, AM_LogitStats* s);
+    void  (*affine)(float* x, int n, float a, float b);
+    float (*rewrite)(float* x, int n, const AM_FieldXform* t);
+    void  (*stats_h)(const uint16_t* x, int n, int fmt, AM_LogitStats* s);
+    float (*rewrite_h)(uint16_t* x, int n, int fmt, const AM_FieldXform* t);
+    float (*rewrite_exp)(float* x, int n, const AM_FieldXform* t,
+                         float m, float inv_t, float* w, float* bmax);
+    float (*dot)(const float* a, const float* b, int n);
+    void  (*axpy)(float* y, const float* x, float a, int n);
+    void  (*delta)(float* out, const float* A, const float* t, int n,
+                   int rank, float alpha);
+    void  (*deq_i8)(const int8_t* q, int n, const float* scale, int group, float* dst);
+    void  (*deq_i4)(const uint8_t* q, int n, const float* scale, int group, float* dst);
+    void  (*rng)(float* out, int n, uint32_t k0, uint32_t k1, uint32_t c0);
+} AM_LogitKernels;
+
+static const AM_LogitKernels g_lk_table[] = {
+    { AM_SIMD_SCALAR, "scalar", lk_sum_scalar, lk_max_scalar, lk_stats_scalar,
+      lk_affine_scalar, lk_rewrite_scalar, lk_stats_h_scalar, lk_rewrite_h_scalar,
+      lk_rewrite_exp_scalar, lk_dot_scalar, lk_axpy_scalar, lk_delta_scalar,
+      lk_deq_i8_scalar, lk_deq_i4_scalar, lk_rng_scalar },
+#ifdef AM_HAVE_NEON
+    { AM_SIMD_NEON, "neon", lk_sum_neon, lk_max_neon, lk_stats_neon,
+      lk_affine_neon, lk_rewrite_neon, lk_stats_h_neon, lk_rewrite_h_neon,
+      lk_rewrite_exp_neon, lk_dot_neon, lk_axpy_neon, lk_delta_neon,
+      lk_deq_i8_neon, lk_deq_i4_neon, lk_rng_neon },
+#endif
+#ifdef AM_HAVE_X86
+    { AM_SIMD_AVX2, "avx2", lk_sum_avx2, lk_max_avx2, lk_stats_avx2,
+      lk_affine_avx2, lk_rewrite_avx2, lk_stats_h_avx2, lk_rewrite_h_avx2,
+      lk_rewrite_exp_avx2, lk_dot_avx2, lk_axpy_avx2, lk_delta_avx2,
+      lk_deq_i8_avx2, lk_deq_i4_avx2, lk_rng_avx2 },
+    { AM_SIMD_AVX512, "avx512", lk_sum_avx512, lk_max_avx512, lk_stats_avx512,
+      lk_affine_avx512, lk_rewrite_avx512, lk_stats_h_avx512, lk_rewrite_h_avx512,
+      lk_rewrite_exp_avx512, lk_dot_avx512, lk_axpy_avx512, lk_delta_avx512,
+      lk_deq_i8_avx512, lk_deq_i4_avx512, lk_rng_avx512 },
+#endif
+};
+#define AM_LK_COUNT ((int)(sizeof(g_lk_table) / sizeof(g_lk_table[0])))
+
+static const AM_LogitKernels* g_lk = &g_lk_table[0];
+
+static int simd_cpu_has(int level) {
+    switch (level) {
+    case AM_SIMD_SCALAR: return 1;
+#ifdef AM_HAVE_NEON
+    case AM_SIMD_NEON:   return 1;
+#endif
+#ifdef AM_HAVE_X86
+    case AM_SIMD_AVX2:   return __builtin_cpu_supports("avx2") &&
+                                __builtin_cpu_supports("f16c");
+    case AM_SIMD_AVX512: return __builtin_cpu_supports("avx512f") &&
+                                simd_cpu_has(AM_SIMD_AVX2);   // shares AVX2 kernels
+#endif
+    default:             return 0;
+    }
+}
+
+int am_simd_set(int level) {
+    const AM_LogitKernels* best = &g_lk_table[0];
+    for (int i = 0; i < AM_LK_COUNT; i++) {
+        const AM_LogitKernels* k = &g_lk_table[i];
+        if (k->level <= level && k->level >= best->level && simd_cpu_has(k->level))
+            best = k;
+    }
+    g_lk = best;
+    return best->level;
+}
+
+int am_simd_level(void) { return g_lk->level; }
+const char* am_simd_name(void) { return g_lk->name; }
+
+// Load time: take the widest kernels this CPU runs.
+__attribute__((constructor))
+static void simd_autoselect(void) {
+#ifdef AM_HAVE_X86
+    __builtin_cpu_init();
+#endif
+    am_simd_set(AM_SIMD_AVX512);
+}
+
+// Laws reductions from the top-2 of the values they act on.
+// The band test (>= top - 0.001) runs after the entropy floor reduction,
+// exactly like the staged rewrite; entries equal to the max get both.
+static void field_laws(float entropy_floor, float resonance_ceiling,
+                       float top, float second, float xmax, AM_FieldXform* t) {
+    float gap = top - second;
+    float r1 = 0.0f, r2 = 0.0f;
+    if (gap > 0.0f && entropy_floor > 0.0f) {
+        float max_gap = (1.0f - entropy_floor) * 10.0f;
+        if (gap > max_gap) r1 = (gap - max_gap) * 0.5f;
+    }
+    if (resonance_ceiling < 1.0f) {
+        float ceiling_gap = resonance_ceiling * 10.0f;
+        if (gap > ceiling_gap) r2 = (gap - ceiling_gap) * 0.3f;
+    }
+    t->xmax = xmax;
+    t->near = top - 0.001f;
+    t->r2 = r2;
+    t->r_top = r1 + ((top - r1 >= t->near) ? r2 : 0.0f);
+}
+
+// Apply destiny bias: suppress tokens far from max (prophecy scales strength)
+// From arianna_dsl.c: dsl_apply_destiny()
+// x - (max - x) * bias/2  →  x*(1 + bias/2) - max*bias/2
+void am_apply_destiny_to_logits(float* logits, int n) {
+    if (n <= 0 || G.destiny_bias < 0.001f) return;
+    float max_logit = g_lk->max(logits, n);
+    float h = G.destiny_bias * 0.5f;
+    g_lk->affine(logits, n, 1.0f + h, -max_logit * h);
+}
+
+// Apply suffering: pain compresses logits toward mean
+// From spec: logits[i] = mean + (logits[i] - mean) * (1 - 0.5 * pain)
+void am_apply_suffering_to_logits(float* logits, int n) {
+    float s = G.pain;
+    if (n <= 0 || s < 0.01f) return;
+    float mean = g_lk->sum(logits, n) / (float)n;
+    float factor = 1.0f - 0.5f * s;
+    g_lk->affine(logits, n, factor, mean * (1.0f - factor));
+}
+
+// Apply attention: focus sharpens distribution, spread blurs it
+void am_apply_attention_to_logits(float* logits, int n) {
+    if (n <= 0) return;
+    float focus = G.attend_focus;
+    float spread = G.attend_spread;
+    if (fabsf(focus - spread) < 0.01f) return;
+
+    float mean = g_lk->sum(logits, n) / (float)n;
+
+    // focus sharpens (amplify deviations), spread blurs (compress deviations)
+    float scale = 0.5f + focus - spread;
+    if (scale < 0.1f) scale = 0.1f;
+    if (scale > 2.0f) scale = 2.0f;
+    g_lk->affine(logits, n, scale, mean * (1.0f - scale));
+}
+
+// Apply laws: entropy floor + resonance ceiling on logit distribution
+// From ariannamethod.lang/src/field.js + arianna_dsl.c
+void am_apply_laws_to_logits(float* logits, int n) {
+    if (n <= 0) return;
+    AM_LogitStats s;
+    AM_FieldXform t;
+    g_lk->stats(logits, n, &s);
+    t.a = 1.0f;
+    t.b = 0.0f;
+    field_laws(G.entropy_floor, G.resonance_ceiling, s.max, s.second, s.max, &t);
+    if (t.r_top == 0.0f && t.r2 == 0.0f) return;
+    g_lk->rewrite(logits, n, &t);
+}
+
+// Apply delta voice: out += alpha * A @ (B @ x)
+// Low-rank weight modulation. From arianna.c/src/delta.c: apply_delta()
+void am_apply_delta_scratch(float* out, const float* A, const float* B,
+                            const float* x, int out_dim, int in_dim, int rank,
+                            float alpha, float* scratch) {
+    if (!out || !A || !B || !x || !scratch || alpha == 0.0f) return;
+    if (out_dim <= 0 || in_dim <= 0 || rank <= 0) return;
+
+    // scratch = B @ x  (rank × 1)
+    for (int r = 0; r < rank; r++)
+        scratch[r] = g_lk->dot(B + (size_t)r * in_dim, x, in_dim);
+    // out += alpha * A @ scratch
+    g_lk->delta(out, A, scratch, out_dim, rank, alpha);
+}
+
+void am_apply_delta(float* out, const float* A, const float* B,
+                    const float* x, int out_dim, int in_dim, int rank,
+                    float alpha) {
+    float temp[AM_DELTA_MAX_STACK_RANK];
+    if (rank <= AM_DELTA_MAX_STACK_RANK) {
+        am_apply_delta_scratch(out, A, B, x, out_dim, in_dim, rank, alpha, temp);
+        return;
+    }
+    float* scratch = (float*)malloc((size_t)rank * sizeof(float));
+    if (!scratch) return;
+    am_apply_delta_scratch(out, A, B, x, out_dim, in_dim, rank, alpha, scratch);
+    free(scratch);
+}
+
+// Batched delta voice: out[b] += alphas[b] * A @ (B @ X[b]) for every row b.
+// T = B @ X^T is a [batch × rank] tile; A is then streamed once in blocks of
+// about AM_DELTA_BLOCK_BYTES, each applied to all sequences while it sits in
+// L2. Per row this runs the same kernel as am_apply_delta, so results match.
+#define AM_DELTA_BLOCK_BYTES 131072
+#define AM_DELTA_STACK_TILE  4096    // floats of T kept on the stack
+
+void am_apply_delta_batch(float* out, const float* A, const float* B,
+                          const float* X, int batch, int out_dim, int in_dim,
+                          int rank, const float* alphas) {
+    if (!out || !A || !B || !X) return;
+    if (batch <= 0 || out_dim <= 0 || in_dim <= 0 || rank <= 0) return;
+
+    float tile[AM_DELTA_STACK_TILE];
+    size_t tn = (size_t)batch * rank;
+    float* T = tile;
+    if (tn > AM_DELTA_STACK_TILE) {
+        T = (float*)malloc(tn * sizeof(float));
+        if (!T) return;
+    }
+
+    // T[b][r] = B[r] . X[b] — each B row is read once and reused across the batch
+    for (int r = 0; r < rank; r++) {
+        const float* br = B + (size_t)r * in_dim;
+        for (int b = 0; b < batch; b++)
+            T[(size_t)b * rank + r] = g_lk->dot(br, X + (size_t)b * in_dim, in_dim);
+    }
+
+    // rows per A block, a multiple of 8 so kernel row blocks line up with
+    // what a single am_apply_delta call would use
+    int rows = (int)(AM_DELTA_BLOCK_BYTES / ((size_t)rank * sizeof(float))) & ~7;
+    if (rows < 8) rows = 8;
+    for (int i = 0; i < out_dim; i += rows) {
+        int m = (out_dim - i < rows) ? out_dim - i : rows;
+        const float* Ai = A + (size_t)i * rank;
+        for (int b = 0; b < batch; b++) {
+            float alpha = alphas ? alphas[b] : 1.0f;
+            if (alpha == 0.0f) continue;
+            g_lk->delta(out + (size_t)b * out_dim + i, Ai, T + (size_t)b * rank,
+                        m, rank, alpha);
+        }
+    }
+
+    if (T != tile) free(T);
+}
+
+// ── stacked adapters ────────────────────────────────────────────────────────
+
+int am_delta_stack_init(AM_DeltaStack* s, int n, const float* const* A,
+                        const float* const* B, const int* ranks,
+                        int out_dim, int in_dim) {
+    if (!s) return -1;
+    memset(s, 0, sizeof(*s));
+    if (!A || !B || !ranks || n <= 0 || n > AM_MAX_GAMMA ||
+        out_dim <= 0 || in_dim <= 0) return -1;
+
+    int rank = 0;
+    for (int k = 0; k < n; k++) {
+        if (ranks[k] < 0 || (ranks[k] > 0 && (!A[k] || !B[k]))) return -1;
+        s->offset[k] = rank;
+        rank += ranks[k];
+    }
+    s->offset[n] = rank;
+    if (rank == 0) return -1;
+
+    s->A = (float*)malloc((size_t)out_dim * rank * sizeof(float));
+    s->B = (float*)malloc((size_t)rank * in_dim * sizeof(float));
+    if (!s->A || !s->B) { am_delta_stack_free(s); return -1; }
+    s->n_adapters = n;
+    s->out_dim = out_dim;
+    s->in_dim = in_dim;
+    s->rank = rank;
+
+    for (int k = 0; k < n; k++) {
+        int rk = ranks[k], o = s->offset[k];
+        if (rk == 0) continue;
+        memcpy(s->B + (size_t)o * in_dim, B[k], (size_t)rk * in_dim * sizeof(float));
+        for (int i = 0; i < out_dim; i++)
+            memcpy(s->A + (size_t)i * rank + o, A[k] + (size_t)i * rk, rk * sizeof(float));
+    }
+    return 0;
+}
+
+void am_delta_stack_free(AM_DeltaStack* s) {
+    if (!s) return;
+    free(s->A);
+    free(s->B);
+    memset(s, 0, sizeof(*s));
+}
+
+// Bx for every adapter in one [rank × in_dim] product, each segment scaled by
+// its alpha, then one rank-wide delta pass: x and out are each read once.
+void am_apply_delta_stack(float* out, const AM_DeltaStack* s, const float* x,
+                          const float* alphas) {
+    if (!out || !s || !s->A || !x) return;
+    if (!alphas) alphas = am_field_plan()->gamma_w;
+
+    int live = 0;
+    for (int k = 0; k < s->n_adapters; k++)
+        if (alphas[k] != 0.0f && s->offset[k + 1] > s->offset[k]) live = 1;
+    if (!live) return;
+
+    float tile[AM_DELTA_MAX_STACK_RANK];
+    float* t = tile;
+    if (s->rank > AM_DELTA_MAX_STACK_RANK) {
+        t = (float*)malloc((size_t)s->rank * sizeof(float));
+        if (!t) return;
+    }
+    for (int k = 0; k < s->n_adapters; k++) {
+        float a = alphas[k];
+        for (int r = s->offset[k]; r < s->offset[k + 1]; r++)
+            t[r] = (a != 0.0f) ? a * g_lk->dot(s->B + (size_t)r * s->in_dim, x, s->in_dim)
+                               : 0.0f;
+    }
+    g_lk->delta(out, s->A, t, s->out_dim, s->rank, 1.0f);
+    if (t != tile) free(t);
+}
+
+// Layout-aware delta voice. Each factor is walked in its storage order:
+// row-major B dots rows with x; column-major B accumulates its rows scaled
+// by x[i] into t. Row-major A goes through the rank kernels; column-major A
+// adds alpha*t[r] times row r into an L1-sized tile of out, rank rows at a
+// time. ROW/ROW is exactly am_apply_delta.
+#define AM_DELTA_COL_TILE 2048    // out floats per column-major A tile
+
+void am_delta_apply(float* out, const AM_DeltaDesc* d, const float* x, float alpha) {
+    if (!out || !d || !d->A || !d->B || !x || alpha == 0.0f) return;
+    int out_dim = d->out_dim, in_dim = d->in_dim, rank = d->rank;
+    if (out_dim <= 0 || in_dim <= 0 || rank <= 0) return;
+
+    float tile[AM_DELTA_MAX_STACK_RANK];
+    float* t = tile;
+    if (rank > AM_DELTA_MAX_STACK_RANK) {
+        t = (float*)malloc((size_t)rank * sizeof(float));
+        if (!t) return;
+    }
+
+    if (d->b_layout == AM_LAYOUT_COL) {
+        memset(t, 0, (size_t)rank * sizeof(float));
+        for (int i = 0; i < in_dim; i++)
+            if (x[i] != 0.0f) g_lk->axpy(t, d->B + (size_t)i * rank, x[i], rank);
+    } else {
+        for (int r = 0; r < rank; r++)
+            t[r] = g_lk->dot(d->B + (size_t)r * in_dim, x, in_dim);
+    }
+
+    if (d->a_layout == AM_LAYOUT_COL) {
+        for (int o = 0; o < out_dim; o += AM_DELTA_COL_TILE) {
+            int n = (out_dim - o < AM_DELTA_COL_TILE) ? out_dim - o : AM_DELTA_COL_TILE;
+            for (int r = 0; r < rank; r++)
+                if (t[r] != 0.0f)
+                    g_lk->axpy(out + o, d->A + (size_t)r * out_dim + o, alpha * t[r], n);
+        }
+    } else {
+        g_lk->delta(out, d->A, t, out_dim, rank, alpha);
+    }
+    if (t != tile) free(t);
+}
+
+// Compute prophecy debt from chosen token (retroactive)
+// From arianna_dsl.c: dsl_compute_prophecy_debt()
+float am_compute_prophecy_debt(const float* logits, int chosen, int n) {
+    if (n <= 0 || chosen < 0 || chosen >= n) return 0.0f;
+    float max_logit = logits[0];
+    for (int i = 1; i < n; i++) {
+        if (logits[i] > max_logit) max_logit = logits[i];
+    }
+    float diff = max_logit - logits[chosen];
+    return diff > 0.0f ? diff / (diff + 1.0f) : 0.0f;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// FUSED FIELD ENGINE — one read pass, one rewrite pass
+//
+// gamma, destiny, suffering and attention are each y = k*x + c with k > 0.
+// Chained they stay affine and order-preserving, so the max, runner-up and
+// mean of every intermediate follow from a single read of the input.
+// Laws only needs the final top-2, which is the image of the input top-2.
+// ─────────────────────────────────────────────────────────────────────────────
+
+void am_field_params_capture(AM_FieldParams* p) {
+    if (!p) return;
+    p->gamma_blend = am_gamma_get_blend();
+    p->essence_alpha = G.essence_alpha;
+    p->destiny_bias = G.destiny_bias;
+    p->pain = G.pain;
+    p->attend_focus = G.attend_focus;
+    p->attend_spread = G.attend_spread;
+    p->entropy_floor = G.entropy_floor;
+    p->resonance_ceiling = G.resonance_ceiling;
+    p->temperature = G.effective_temp;
+}
+
+// ── per-step plan ───────────────────────────────────────────────────────────
+// Scales and stage mask resolved once per step (am_step, am_exec, gamma
+// changes), so the per-token path never touches G or scans gamma slots.
+// Stages whose scale is exactly 1 are dropped from the mask.
+
+static AM_FieldPlan g_plan;   // zero stages: identity until the first build
+
+static void field_plan_compile(const AM_FieldParams* p, AM_FieldPlan* plan) {
+    memset(plan, 0, sizeof(*plan));
+    plan->gamma_blend = p->gamma_blend;
+    plan->gamma_k = plan->pain_k = plan->attend_k = 1.0f;
+    plan->entropy_floor = p->entropy_floor;
+    plan->resonance_ceiling = p->resonance_ceiling;
+    plan->inv_temp = 1.0f / fmaxf(p->temperature, 1e-3f);
+
+    if (p->gamma_blend >= 0.001f) {
+        plan->gamma_k = 1.0f + p->gamma_blend * p->essence_alpha;
+        if (plan->gamma_k != 1.0f) plan->stages |= AM_PLAN_GAMMA;
+    }
+    if (p->destiny_bias >= 0.001f) {
+        plan->destiny_h = p->destiny_bias * 0.5f;
+        plan->stages |= AM_PLAN_DESTINY;
+    }
+    if (p->pain >= 0.01f) {
+        plan->pain_k = 1.0f - 0.5f * p->pain;
+        if (plan->pain_k != 1.0f) plan->stages |= AM_PLAN_SUFFERING;
+    }
+    if (fabsf(p->attend_focus - p->attend_spread) >= 0.01f) {
+        float k = 0.5f + p->attend_focus - p->attend_spread;
+        if (k < 0.1f) k = 0.1f;
+        if (k > 2.0f) k = 2.0f;
+        plan->attend_k = k;
+        if (k != 1.0f) plan->stages |= AM_PLAN_ATTENTION;
+    }
+    if (p->entropy_floor > 0.0f) plan->stages |= AM_PLAN_FLOOR;
+    if (p->resonance_ceiling < 1.0f) plan->stages |= AM_PLAN_CEILING;
+}
+
+void am_field_plan_build(void) {
+    AM_FieldParams p;
+    am_field_params_capture(&p);
+    field_plan_compile(&p, &g_plan);
+    am_gamma_slot_weights(g_plan.gamma_w);
+}
+
+const AM_FieldPlan* am_field_plan(void) { return &g_plan; }
+
+// Fold the plan into one affine map + laws reductions for this row.
+static void field_xform(const AM_FieldPlan* plan, const AM_LogitStats* s,
+                        AM_FieldXform* t) {
+    float a = 1.0f, b = 0.0f;
+    float mean = s->mean, mx = s->max;
+    unsigned int st = plan->stages;
+
+    if (st & AM_PLAN_GAMMA) {
+        float k = plan->gamma_k;
+        a *= k; b = b * k + mean * (1.0f - k);
+        mx = mean + (mx - mean) * k;
+    }
+    if (st & AM_PLAN_DESTINY) {
+        float h = plan->destiny_h;
+        float k = 1.0f + h;
+        a *= k; b = b * k - mx * h;
+        mean = mean * k - mx * h;   // the max itself stays put
+    }
+    if (st & AM_PLAN_SUFFERING) {
+        float k = plan->pain_k;
+        a *= k; b = b * k + mean * (1.0f - k);
+    }
+    if (st & AM_PLAN_ATTENTION) {
+        float k = plan->attend_k;
+        a *= k; b = b * k + mean * (1.0f - k);
+    }
+
+    float top = a * s->max + b;
+    float second = (s->second > -1e30f) ? a * s->second + b : -1e30f;
+    t->a = a;
+    t->b = b;
+    field_laws(plan->entropy_floor, plan->resonance_ceiling, top, second, s->max, t);
+}
+
+// Rows are float, bf16 or fp16; the engine only sees them through these.
+static void row_stats(const void* x, int n, int fmt, AM_LogitStats* s) {
+    if (fmt == LF_F32) g_lk->stats((const float*)x, n, s);
+    else g_lk->stats_h((const uint16_t*)x, n, fmt, s);
+}
+
+// Returns the max of the rewritten row. Half kernels report the max before
+// rounding; rounding is monotonic, so rounding it once gives the stored max.
+static float row_rewrite(void* x, int n, int fmt, const AM_FieldXform* t) {
+    if (fmt == LF_F32) return g_lk->rewrite((float*)x, n, t);
+    uint16_t mx = half_put(g_lk->rewrite_h((uint16_t*)x, n, fmt, t), fmt);
+    return half_get(&mx, 0, fmt);
+}
+
+static inline int xform_is_identity(const AM_FieldXform* t) {
+    return t->a == 1.0f && t->b == 0.0f && t->r_top == 0.0f && t->r2 == 0.0f;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// FIELD THREAD POOL — vocabulary sharding for very large rows
+//
+// Persistent workers; the caller runs shard 0 itself. Workers spin briefly
+// on the job generation before sleeping, so back-to-back decode steps do
+// not pay a futex wake per phase. One job at a time: a second host thread
+// that finds the pool busy just runs single-threaded.
+// ─────────────────────────────────────────────────────────────────────────────
+
+#ifdef AM_HAVE_THREADS
+
+typedef void (*AM_ShardFn)(void* arg, int shard, int nshards);
+
+typedef struct {
+    pthread_t       th[AM_FIELD_MAX_THREADS];
+    int             nthreads;      // shards per job, caller included
+    int             min_n;         // rows shorter than this stay serial
+    pthread_mutex_t mu;
+    pthread_cond_t  wake;
+    pthread_mutex_t busy;          // held by the caller running a job
+    AM_ShardFn      fn;
+    void*           arg;
+    atomic_uint     gen;           // bumped once per job
+    atomic_int      pending;       // workers yet to finish the job
+    int             quit;
+} AM_FieldPool;
+
+typedef struct { AM_FieldPool* pool; int id; unsigned gen0; } AM_PoolSeat;
+
+static AM_FieldPool g_pool = {
+    .mu = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .busy = PTHREAD_MUTEX_INITIALIZER,
+    .nthreads = 1,
+};
+static AM_PoolSeat g_pool_seats[AM_FIELD_MAX_THREADS];
+
+static void* pool_worker(void* p) {
+    AM_PoolSeat* seat = (AM_PoolSeat*)p;
+    AM_FieldPool* pool = seat->pool;
+    unsigned seen = seat->gen0;   // sampled before the thread existed
+    for (;;) {
+        int spins = 0;
+        while (atomic_load_explicit(&pool->gen, memory_order_acquire) == seen &&
+               spins < 4096)
+            spins++;
+        pthread_mutex_lock(&pool->mu);
+        while (atomic_load(&pool->gen) == seen && !pool->quit)
+            pthread_cond_wait(&pool->wake, &pool->mu);
+        if (pool->quit) { pthread_mutex_unlock(&pool->mu); return NULL; }
+        seen = atomic_load(&pool->gen);
+        AM_ShardFn fn = pool->fn;
+        void* arg = pool->arg;
+        int nshards = pool->nthreads;
+        pthread_mutex_unlock(&pool->mu);
+
+        fn(arg, seat->id, nshards);
+        atomic_fetch_sub_explicit(&pool->pending, 1, memory_order_release);
+    }
+}
+
+static void pool_stop(AM_FieldPool* pool) {
+    if (pool->nthreads <= 1) return;
+    pthread_mutex_lock(&pool->mu);
+    pool->quit = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->mu);
+    for (int i = 1; i < pool->nthreads; i++) pthread_join(pool->th[i], NULL);
+    pool->quit = 0;
+    pool->nthreads = 1;
+}
+
+// Claim the pool for one job: returns the shard count, fixed until
+// pool_release, or 0 if the pool is off, busy or the row is too short.
+static int pool_acquire(int n) {
+    AM_FieldPool* pool = &g_pool;
+    if (pthread_mutex_trylock(&pool->busy) != 0) return 0;
+    if (pool->nthreads <= 1 || n < pool->min_n) {
+        pthread_mutex_unlock(&pool->busy);
+        return 0;
+    }
+    return pool->nthreads;
+}
+
+static void pool_release(void) { pthread_mutex_unlock(&g_pool.busy); }
+
+// Run fn over every shard of a claimed pool.
+static void pool_run(AM_ShardFn fn, void* arg) {
+    AM_FieldPool* pool = &g_pool;
+    atomic_store(&pool->pending, pool->nthreads - 1);
+    pthread_mutex_lock(&pool->mu);
+    pool->fn = fn;
+    pool->arg = arg;
+    atomic_fetch_add_explicit(&pool->gen, 1, memory_order_release);
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->mu);
+
+    fn(arg, 0, pool->nthreads);
+    while (atomic_load_explicit(&pool->pending, memory_order_acquire) > 0)
+        sched_yield();
+}
+
+int am_field_threads(int nthreads, int min_n) {
+    AM_FieldPool* pool = &g_pool;
+    if (nthreads > AM_FIELD_MAX_THREADS) nthreads = AM_FIELD_MAX_THREADS;
+    if (nthreads < 1) nthreads = 1;
+    pthread_mutex_lock(&pool->busy);
+    pool->min_n = (min_n > 0) ? min_n : AM_FIELD_THREAD_MIN_N;
+    if (nthreads != pool->nthreads) {
+        pool_stop(pool);
+        int started = 1;
+        for (int i = 1; i < nthreads; i++) {
+            g_pool_seats[i].pool = pool;
+            g_pool_seats[i].id = i;
+            g_pool_seats[i].gen0 = atomic_load(&pool->gen);
+            if (pthread_create(&pool->th[i], NULL, pool_worker, &g_pool_seats[i]) != 0)
+                break;
+            started++;
+        }
+        pool->nthreads = started;
+    }
+    pthread_mutex_unlock(&pool->busy);
+    return pool->nthreads;
+}
+
+// Sharded row: phase 1 reduces each shard, the caller merges the partial
+// top-2 and sums; phase 2 rewrites each shard with the merged transform.
+// Shards are 32-element aligned so no two threads write one cache line.
+typedef struct {
+    void*                 x;
+    int                   fmt;
+    int                   n;
+    int                   chunk;
+    const AM_FieldPlan*   plan;
+    AM_LogitStats         part[AM_FIELD_MAX_THREADS];
+    float                 out_max[AM_FIELD_MAX_THREADS];
+    AM_FieldXform         t;
+} AM_FieldJob;
+
+static inline void* row_at(void* x, int fmt, int i) {
+    return (fmt == LF_F32) ? (void*)((float*)x + i) : (void*)((uint16_t*)x + i);
+}
+
+static int shard_range(const AM_FieldJob* job, int shard, int* len) {
+    int start = shard * job->chunk;
+    *len = (start < job->n) ? job->n - start : 0;
+    if (*len > job->chunk) *len = job->chunk;
+    return start;
+}
+
+static void shard_stats(void* arg, int shard, int nshards) {
+    (void)nshards;
+    AM_FieldJob* job = (AM_FieldJob*)arg;
+    int len, start = shard_range(job, shard, &len);
+    if (len > 0) row_stats(row_at(job->x, job->fmt, start), len, job->fmt, &job->part[shard]);
+}
+
+static void shard_rewrite(void* arg, int shard, int nshards) {
+    (void)nshards;
+    AM_FieldJob* job = (AM_FieldJob*)arg;
+    int len, start = shard_range(job, shard, &len);
+    job->out_max[shard] = (len > 0)
+        ? row_rewrite(row_at(job->x, job->fmt, start), len, job->fmt, &job->t)
+        : -INFINITY;
+}
+
+static int field_apply_sharded(void* x, int n, int fmt, const AM_FieldPlan* plan,
+                               float* out_max) {
+    // Both phases run under one claim, so the shard count cannot change
+    // between them.
+    int nshards = pool_acquire(n);
+    if (!nshards) return 0;
+    AM_FieldJob job;
+    job.x = x;
+    job.fmt = fmt;
+    job.n = n;
+    job.plan = plan;
+    job.chunk = ((n + nshards - 1) / nshards + 31) & ~31;
+    pool_run(shard_stats, &job);
+
+    AM_LogitStats s = { -INFINITY, -1e30f, 0.0f };
+    float sum = 0.0f;
+    for (int k = 0; k < nshards; k++) {
+        int len;
+        shard_range(&job, k, &len);
+        if (len <= 0) continue;
+        sum += job.part[k].mean * (float)len;
+        top2_push(job.part[k].max, &s.max, &s.second);
+        top2_push(job.part[k].second, &s.max, &s.second);
+    }
+    s.mean = sum / (float)n;
+    field_xform(plan, &s, &job.t);
+    if (xform_is_identity(&job.t)) {
+        *out_max = s.max;
+    } else {
+        pool_run(shard_rewrite, &job);
+        *out_max = -INFINITY;
+        for (int k = 0; k < nshards; k++) *out_max = fmaxf(*out_max, job.out_max[k]);
+    }
+    pool_release();
+    return 1;
+}
+
+#else
+
+int am_field_threads(int nthreads, int min_n) {
+    (void)nthreads; (void)min_n;
+    return 1;
+}
+
+static int field_apply_sharded(void* x, int n, int fmt, const AM_FieldPlan* plan,
+                               float* out_max) {
+    (void)x; (void)n; (void)fmt; (void)plan; (void)out_max;
+    return 0;
+}
+
+#endif // AM_HAVE_THREADS
+
+// Returns 1 with the row's final max, or 0 if an empty plan skipped the row.
+static int field_apply_row(void* x, int n, int fmt, const AM_FieldPlan* plan,
+                           float* out_max) {
+    if (!plan->stages) return 0;
+    if (field_apply_sharded(x, n, fmt, plan, out_max)) return 1;
+    AM_LogitStats s;
+    AM_FieldXform t;
+    row_stats(x, n, fmt, &s);
+    field_xform(plan, &s, &t);
+    *out_max = xform_is_identity(&t) ? s.max : row_rewrite(x, n, fmt, &t);
+    return 1;
+}
+
+// Last row a field pass produced. am_commit_token prices the chosen token
+// against it in O(1); the max comes for free from the rewrite pass.
+static struct {
+    const void* row;
+    int         n;
+    int         fmt;
+    int         has_max;
+    float       max;
+} g_last_row;
+
+static void last_row_set(const void* row, int n, int fmt, int has_max, float mx) {
+    g_last_row.row = row;
+    g_last_row.n = n;
+    g_last_row.fmt = fmt;
+    g_last_row.has_max = has_max;
+    g_last_row.max = mx;
+}
+
+// Full pipeline: apply all field effects to logits
+// Fused: equivalent to gamma → destiny → suffering → attention → laws,
+// equal to the staged chain up to float rounding of the intermediate means.
+void am_apply_field_to_logits(float* logits, int n) {
+    if (!logits || n <= 0) return;
+    float mx = 0.0f;
+    int has_max = field_apply_row(logits, n, LF_F32, &g_plan, &mx);
+    last_row_set(logits, n, LF_F32, has_max, mx);
+}
+
+// Batched pipeline over a [rows × n] tile. Rows share the current plan,
+// or each compiles its own from params; every row is reduced and rewritten
+// back-to-back so the rewrite hits the row while it is still in cache.
+void am_apply_field_to_logits_batch(float* logits, int rows, int n,
+                                    int row_stride, const AM_FieldParams* params) {
+    if (!logits || rows <= 0 || n <= 0 || row_stride < n) return;
+    AM_FieldPlan row_plan;
+    float mx;
+    for (int r = 0; r < rows; r++) {
+        float* row = logits + (size_t)r * (size_t)row_stride;
+        if (params) field_plan_compile(&params[r], &row_plan);
+        field_apply_row(row, n, LF_F32, params ? &row_plan : &g_plan, &mx);
+    }
+    last_row_set(NULL, 0, LF_F32, 0, 0.0f);   // no single row to price against
+}
+
+// Full-vocabulary mean, reduced exactly as the dense pipeline reduces it.
+float am_logit_mean(const float* logits, int n) {
+    if (!logits || n <= 0) return 0.0f;
+    AM_LogitStats s;
+    g_lk->stats(logits, n, &s);
+    return s.mean;
+}
+
+// Sparse candidate mode. Every transform is position-independent and reads
+// only the vocabulary mean and top-2, so a shortlist holding the dense top-2
+// plus the dense mean yields exactly the dense values for those entries.
+void am_apply_field_to_candidates(float* values, int k, float vocab_mean) {
+    if (!values || k <= 0) return;
+    if (!g_plan.stages) { last_row_set(values, k, LF_F32, 0, 0.0f); return; }
+    AM_LogitStats s;
+    AM_FieldXform t;
+    g_lk->stats(values, k, &s);
+    s.mean = vocab_mean;
+    field_xform(&g_plan, &s, &t);
+    float mx = xform_is_identity(&t) ? s.max : g_lk->rewrite(values, k, &t);
+    last_row_set(values, k, LF_F32, 1, mx);
+}
+
+// Half-precision pipeline: same transform, stats in fp32, rows stay 16-bit.
+static void field_apply_half(uint16_t* logits, int n, int fmt) {
+    if (!logits || n <= 0) return;
+    float mx = 0.0f;
+    int has_max = field_apply_row(logits, n, fmt, &g_plan, &mx);
+    last_row_set(logits, n, fmt, has_max, mx);
+}
+
+void am_apply_field_to_logits_bf16(uint16_t* logits, int n) {
+    field_apply_half(logits, n, LF_BF16);
+}
 
-  return 0;
+void am_apply_field_to_logits_fp16(uint16_t* logits, int n) {
+    field_apply_half(logits, n, LF_FP16);
 }
 
-// ═══════════════════════════════════════════════════════════════════════════════
-// LOGIT MANIPULATION API — apply field state to generation
-// Ported from arianna_dsl.c, ariannamethod.lang/src/field.js
-// ═══════════════════════════════════════════════════════════════════════════════
+static float prophecy_debt_half(const uint16_t* logits, int chosen, int n, int fmt) {
+    if (!logits || n <= 0 || chosen < 0 || chosen >= n) return 0.0f;
+    AM_LogitStats s;
+    g_lk->stats_h(logits, n, fmt, &s);
+    float diff = s.max - half_get(logits, chosen, fmt);
+    return diff > 0.0f ? diff / (diff + 1.0f) : 0.0f;
+}
 
-// Apply destiny bias: suppress tokens far from max (prophecy scales strength)
-// From arianna_dsl.c: dsl_apply_destiny()
-void am_apply_destiny_to_logits(float* logits, int n) {
-    if (n <= 0 || G.destiny_bias < 0.001f) return;
-    float max_logit = logits[0];
-    for (int i = 1; i < n; i++) {
-        if (logits[i] > max_logit) max_logit = logits[i];
-    }
-    for (int i = 0; i < n; i++) {
-        float diff = max_logit - logits[i];
-        float suppress = diff * G.destiny_bias * 0.5f;
-        logits[i] -= suppress;
-    }
+float am_compute_prophecy_debt_bf16(const uint16_t* logits, int chosen, int n) {
+    return prophecy_debt_half(logits, chosen, n, LF_BF16);
 }
 
-// Apply suffering: pain compresses logits toward mean
-// From spec: logits[i] = mean + (logits[i] - mean) * (1 - 0.5 * pain)
-void am_apply_suffering_to_logits(float* logits, int n) {
-    float s = G.pain;
-    if (n <= 0 || s < 0.01f) return;
-    float mean = 0.0f;
-    for (int i = 0; i < n; i++) mean += logits[i];
-    mean /= (float)n;
-    float factor = 1.0f - 0.5f * s;
-    for (int i = 0; i < n; i++) {
-        logits[i] = mean + (logits[i] - mean) * factor;
-    }
+float am_compute_prophecy_debt_fp16(const uint16_t* logits, int chosen, int n) {
+    return prophecy_debt_half(logits, chosen, n, LF_FP16);
 }
 
-// Apply attention: focus sharpens distribution, spread blurs it
-void am_apply_attention_to_logits(float* logits, int n) {
-    if (n <= 0) return;
-    float focus = G.attend_focus;
-    float spread = G.attend_spread;
-    if (fabsf(focus - spread) < 0.01f) return;
+// ── fused sampler ───────────────────────────────────────────────────────────
+// Pass 1 reduces the row; pass 2 rewrites it block by block, emitting
+// softmax weights against the top entry's final value (online max: a block
+// that laws pushed higher rescales what came before). Sampling is a
+// single-slot weighted reservoir with exponential jumps: entry j replaces
+// the pick once the running weight passes W_pick / u, so only O(log n)
+// random draws are made and the normaliser is never divided through.
+
+#define AM_SAMPLE_BLOCK 256
+
+static inline uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
 
-    float mean = 0.0f;
-    for (int i = 0; i < n; i++) mean += logits[i];
-    mean /= (float)n;
+// uniform in (0, 1]
+static inline double sample_unit(uint64_t* state) {
+    return (double)((splitmix64(state) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
 
-    // focus sharpens (amplify deviations), spread blurs (compress deviations)
-    float scale = 0.5f + focus - spread;
-    if (scale < 0.1f) scale = 0.1f;
-    if (scale > 2.0f) scale = 2.0f;
-    for (int i = 0; i < n; i++) {
-        logits[i] = mean + (logits[i] - mean) * scale;
+// ── counter-based streams ──────────────────────────────────────────────────
+// Draw i of a stream is a pure function of (key, i): no shared state, no
+// lock, and a whole vector of draws comes out of one kernel call.
+
+void am_rng_seed(AM_Rng* g, uint64_t seed) {
+    if (!g) return;
+    g->key = splitmix64(&seed);
+    g->ctr = 0;
+}
+
+void am_rng_fill(AM_Rng* g, float* out, int n) {
+    if (!g || !out || n <= 0) return;
+    while (n > 0) {
+        // the high counter word joins the key; split where the low word wraps
+        uint32_t c0 = (uint32_t)g->ctr;
+        uint64_t room = 0x100000000ull - c0;
+        int m = ((uint64_t)n < room) ? n : (int)room;
+        uint32_t k1 = (uint32_t)(g->key >> 32) ^ ((uint32_t)(g->ctr >> 32) * 0x9E3779B9u);
+        g_lk->rng(out, m, (uint32_t)g->key, k1, c0);
+        g->ctr += (uint64_t)m;
+        out += m;
+        n -= m;
     }
 }
 
-// Apply laws: entropy floor + resonance ceiling on logit distribution
-// From ariannamethod.lang/src/field.js + arianna_dsl.c
-void am_apply_laws_to_logits(float* logits, int n) {
-    if (n <= 0) return;
+float am_rng_uniform(AM_Rng* g) {
+    float u = 0.0f;
+    am_rng_fill(g, &u, 1);
+    return u;
+}
 
-    // Entropy floor: if max logit dominates too much, compress
-    float max_val = logits[0], second_max = -1e30f;
-    for (int i = 1; i < n; i++) {
-        if (logits[i] > max_val) { second_max = max_val; max_val = logits[i]; }
-        else if (logits[i] > second_max) second_max = logits[i];
-    }
-    float gap = max_val - second_max;
-    if (gap > 0.0f && G.entropy_floor > 0.0f) {
-        float max_gap = (1.0f - G.entropy_floor) * 10.0f;
-        if (gap > max_gap) {
-            float reduce = (gap - max_gap) * 0.5f;
-            for (int i = 0; i < n; i++) {
-                if (logits[i] == max_val) logits[i] -= reduce;
-            }
-        }
-    }
+// Default streams for calls that are not given one: one per thread, so
+// those calls never share a counter. am_init bumps the epoch and each
+// thread reseeds its stream on its next draw.
+typedef struct { AM_Rng rng; unsigned epoch; } AM_ThreadRng;
 
-    // Resonance ceiling: cap max probability by compressing top logit
-    if (G.resonance_ceiling < 1.0f) {
-        float ceiling_gap = G.resonance_ceiling * 10.0f;
-        float new_gap = max_val - second_max;
-        if (new_gap > ceiling_gap) {
-            float reduce = (new_gap - ceiling_gap) * 0.3f;
-            for (int i = 0; i < n; i++) {
-                if (logits[i] >= max_val - 0.001f) logits[i] -= reduce;
-            }
-        }
+#ifdef AM_HAVE_THREADS
+#define AM_THREAD_LOCAL _Thread_local
+static atomic_uint g_rng_epoch = 1;
+#else
+#define AM_THREAD_LOCAL
+static unsigned g_rng_epoch = 1;
+#endif
+
+static void rng_forget(void) { g_rng_epoch++; }
+
+static AM_Rng* thread_rng(AM_ThreadRng* t, uint64_t seed) {
+    unsigned epoch = g_rng_epoch;
+    if (t->epoch != epoch) {
+        am_rng_seed(&t->rng, seed);
+        t->epoch = epoch;
     }
+    return &t->rng;
 }
 
-// Apply delta voice: out += alpha * A @ (B @ x)
-// Low-rank weight modulation. From arianna.c/src/delta.c: apply_delta()
-void am_apply_delta(float* out, const float* A, const float* B,
-                    const float* x, int out_dim, int in_dim, int rank,
-                    float alpha) {
-    if (!out || !A || !B || !x || alpha == 0.0f) return;
-    if (rank > 128) rank = 128;
+static AM_THREAD_LOCAL AM_ThreadRng t_tunnel;
 
-    // temp = B @ x  (rank × 1)
-    float temp[128];
-    for (int r = 0; r < rank; r++) {
-        temp[r] = 0.0f;
-        for (int j = 0; j < in_dim; j++) {
-            temp[r] += B[r * in_dim + j] * x[j];
-        }
-    }
-    // out += alpha * A @ temp
-    for (int i = 0; i < out_dim; i++) {
-        float sum = 0.0f;
-        for (int r = 0; r < rank; r++) {
-            sum += A[i * rank + r] * temp[r];
-        }
-        out[i] += alpha * sum;
-    }
+int am_should_tunnel_rng(AM_Rng* rng) {
+    if (G.dissonance < G.tunnel_threshold) return 0;
+    return am_rng_uniform(rng ? rng : thread_rng(&t_tunnel, 0x7E11E1ull)) < G.tunnel_chance;
 }
 
-// Compute prophecy debt from chosen token (retroactive)
-// From arianna_dsl.c: dsl_compute_prophecy_debt()
-float am_compute_prophecy_debt(const float* logits, int chosen, int n) {
-    if (n <= 0 || chosen < 0 || chosen >= n) return 0.0f;
-    float max_logit = logits[0];
-    for (int i = 1; i < n; i++) {
-        if (logits[i] > max_logit) max_logit = logits[i];
+float am_sample_field(float* logits, int n, uint64_t* rng_state, int* chosen) {
+    if (chosen) *chosen = -1;
+    if (!logits || n <= 0 || !rng_state) return 0.0f;
+
+    const AM_FieldPlan* plan = &g_plan;
+    AM_LogitStats s;
+    AM_FieldXform t;
+    g_lk->stats(logits, n, &s);
+    field_xform(plan, &s, &t);
+
+    float inv_t = plan->inv_temp;
+    float m = t.a * s.max + t.b - t.r_top;   // final value of the input top
+    float w[AM_SAMPLE_BLOCK];
+    double total = 0.0, jump = 0.0;
+    int pick = -1;
+    for (int i0 = 0; i0 < n; i0 += AM_SAMPLE_BLOCK) {
+        int len = n - i0 < AM_SAMPLE_BLOCK ? n - i0 : AM_SAMPLE_BLOCK;
+        float bmax;
+        float bsum = g_lk->rewrite_exp(logits + i0, len, &t, m, inv_t, w, &bmax);
+        if (bmax > m) {
+            double scale = exp((double)(m - bmax) * inv_t);
+            total *= scale;
+            jump *= scale;
+            m = bmax;
+            bsum = 0.0f;
+            for (int j = 0; j < len; j++) {
+                w[j] = expf((logits[i0 + j] - m) * inv_t);
+                bsum += w[j];
+            }
+        }
+        if (total + bsum < jump) { total += bsum; continue; }
+        for (int j = 0; j < len; j++) {
+            total += w[j];
+            if (total >= jump && w[j] > 0.0f) {
+                pick = i0 + j;
+                jump = total / sample_unit(rng_state);
+            }
+        }
     }
-    float diff = max_logit - logits[chosen];
+    last_row_set(logits, n, LF_F32, 1, m);
+    if (pick < 0) return 0.0f;
+    if (chosen) *chosen = pick;
+    float diff = m - logits[pick];
     return diff > 0.0f ? diff / (diff + 1.0f) : 0.0f;
 }
 
-// Full pipeline: apply all field effects to logits
-void am_apply_field_to_logits(float* logits, int n) {
-    if (!logits || n <= 0) return;
-    am_apply_gamma_to_logits(logits, n);  // personality first
-    am_apply_destiny_to_logits(logits, n);
-    am_apply_suffering_to_logits(logits, n);
-    am_apply_attention_to_logits(logits, n);
-    am_apply_laws_to_logits(logits, n);
+// Price the chosen token against the last field row and fold it into the
+// field: debt accumulates (same cap as am_step), off-destiny choices build
+// tension, and the per-token counters advance.
+float am_commit_token(int chosen) {
+    if (!g_last_row.row || chosen < 0 || chosen >= g_last_row.n) return 0.0f;
+    if (!g_last_row.has_max) {   // empty plan: the field pass never read the row
+        AM_LogitStats s;
+        row_stats(g_last_row.row, g_last_row.n, g_last_row.fmt, &s);
+        g_last_row.max = s.max;
+        g_last_row.has_max = 1;
+    }
+    float v = (g_last_row.fmt == LF_F32)
+        ? ((const float*)g_last_row.row)[chosen]
+        : half_get((const uint16_t*)g_last_row.row, chosen, g_last_row.fmt);
+    float diff = g_last_row.max - v;
+    float debt = diff > 0.0f ? diff / (diff + 1.0f) : 0.0f;
+
+    G.debt += debt;
+    if (G.debt > 100.0f) G.debt = 100.0f;
+    G.tension = clamp01(G.tension + debt * 0.05f);
+    G.last_debt = debt;
+    G.tokens_committed++;
+    if (G.wormhole_active) G.wormhole_tokens++;
+    return debt;
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════
@@ -2242,6 +5129,7 @@ int am_gamma_load(const char* name, float alpha) {
     int idx = gamma_find(name);
     if (idx >= 0) {
         G.gamma[idx].alpha = clamp01(alpha);
+        am_field_plan_build();
         return idx;
     }
 
@@ -2258,6 +5146,7 @@ int am_gamma_load(const char* name, float alpha) {
         G.essence_alpha = alpha;
     }
 
+    am_field_plan_build();
     return idx;
 }
 
@@ -2267,11 +5156,13 @@ void am_gamma_unload(const char* name) {
     G.gamma[idx].active = 0;
     G.gamma[idx].alpha = 0.0f;
     G.gamma[idx].name[0] = 0;
+    am_field_plan_build();
 }
 
 void am_gamma_set_alpha(const char* name, float alpha) {
     int idx = gamma_find(name);
     if (idx >= 0) G.gamma[idx].alpha = clamp01(alpha);
+    am_field_plan_build();
 }
 
 int am_gamma_active(void) {
@@ -2308,6 +5199,22 @@ float am_gamma_get_blend(void) {
     return (idx >= 0) ? G.gamma[idx].alpha * G.essence_alpha : 0.0f;
 }
 
+// Same cases as am_gamma_get_blend, kept per slot.
+void am_gamma_slot_weights(float* w) {
+    if (!w) return;
+    for (int i = 0; i < AM_MAX_GAMMA; i++) w[i] = 0.0f;
+    if (G.n_gamma == 0) return;
+    if (G.janus_mode == AM_JANUS_DUAL || G.janus_mode == AM_JANUS_CYCLE) {
+        if (G.janus_a >= 0 && G.janus_a < G.n_gamma)
+            w[G.janus_a] += G.gamma[G.janus_a].alpha * (1.0f - G.janus_blend);
+        if (G.janus_b >= 0 && G.janus_b < G.n_gamma)
+            w[G.janus_b] += G.gamma[G.janus_b].alpha * G.janus_blend;
+        return;
+    }
+    int idx = am_gamma_active();
+    if (idx >= 0) w[idx] = G.gamma[idx].alpha * G.essence_alpha;
+}
+
 void am_janus_set(const char* face_a, const char* face_b) {
     int a = gamma_find(face_a);
     int b = gamma_find(face_b);
@@ -2319,6 +5226,7 @@ void am_janus_set(const char* face_a, const char* face_b) {
     G.janus_b = b;
     G.janus_mode = AM_JANUS_DUAL;
     G.janus_blend = 0.5f;
+    am_field_plan_build();
 }
 
 // Apply gamma modulation to logits.
@@ -2329,16 +5237,11 @@ void am_apply_gamma_to_logits(float* logits, int n) {
     float blend = am_gamma_get_blend();
     if (blend < 0.001f) return;  // no personality active
 
-    // Compute mean
-    float mean = 0.0f;
-    for (int i = 0; i < n; i++) mean += logits[i];
-    mean /= (float)n;
+    float mean = g_lk->sum(logits, n) / (float)n;
 
     // Gamma amplifies deviation from mean — personality = signal above noise
     float scale = 1.0f + blend * G.essence_alpha;
-    for (int i = 0; i < n; i++) {
-        logits[i] = mean + (logits[i] - mean) * scale;
-    }
+    g_lk->affine(logits, n, scale, mean * (1.0f - scale));
 }
 
 // ═══════════════════════════════════════════════════════════════════════════════
@@ -2353,81 +5256,721 @@ void am_apply_gamma_to_logits(float* logits, int n) {
 // Adaptive decay: stronger when delta norm is large
 // ═══════════════════════════════════════════════════════════════════════════════
 
-// Simple deterministic pseudo-random (from arianna.c)
-static float am_frandn(unsigned int* seed) {
-    *seed = *seed * 1664525u + 1013904223u;
-    // Box-Muller approximation
-    float u = (float)(*seed & 0x7FFFFFFF) / (float)0x7FFFFFFF;
-    return (u - 0.5f) * 3.464f;  // ~N(0,1) rough approximation
+// Channel stream of the calls that are not given one (seed 42 per thread)
+static AM_THREAD_LOCAL AM_ThreadRng t_notorch;
+
+static AM_Rng* notorch_rng(AM_Rng* rng) {
+    return rng ? rng : thread_rng(&t_notorch, 42);
+}
+
+// Build noise-modulated channel vector u from one vector of draws
+// Stronger signal → cleaner channel (less noise)
+static void notorch_channels(float* u, int rank, float g, AM_Rng* rng) {
+    am_rng_fill(rng, u, rank);
+    float k = 0.35f + 0.65f * (1.0f - fabsf(g));
+    for (int r = 0; r < rank; r++)
+        u[r] = (u[r] - 0.5f) * 3.464f * k;   // unit-variance uniform, ~N(0,1)
+}
+
+// Adaptive decay: stronger when delta norm is large
+static float notorch_decay(float base, float a_rms) {
+    if (!(base > 0.0f && base < 1.0f)) return 1.0f;
+    float d = base - 0.004f * fminf(a_rms / 10.0f, 1.0f);
+    return d < 0.990f ? 0.990f : d;
+}
+
+static inline float notorch_clamp_at(float v, float lim) {
+    v = (v > lim) ? lim : v;
+    return (v < -lim) ? -lim : v;
+}
+
+static float notorch_clamp(float v) { return notorch_clamp_at(v, 10.0f); }
+
+// NOTORCH step on a layout descriptor, one pass per factor: Hebbian update,
+// adaptive decay and clamp per element, in each layout's storage order, with
+// B's sum of squares gathered on the way out (B is NOTORCH's A: in → rank).
+// The decay reads the RMS carried from the previous step, so there is no
+// separate reduction; *b_rms < 0 measures it once first. Every layout forms
+// the same products, so they all produce the same matrices.
+static void delta_learn(const AM_DeltaDesc* d, const float* x, const float* dy,
+                        float signal, float* b_rms) {
+    int out_dim = d->out_dim, in_dim = d->in_dim, rank = d->rank;
+
+    // Clamp signal
+    float g = clampf(signal, -2.0f, 2.0f);
+    float lr = G.notorch_lr;
+
+    float u[128], ur[128];
+    notorch_channels(u, rank, g, notorch_rng(d->rng));
+    for (int r = 0; r < rank; r++) ur[r] = u[r] * lr * g;
+
+    size_t b_size = (size_t)in_dim * rank;
+    if (*b_rms < 0.0f) {
+        double ss = 0.0;
+        for (size_t i = 0; i < b_size; i++) ss += (double)d->B[i] * d->B[i];
+        *b_rms = b_size ? (float)sqrt(ss / (double)b_size) : 0.0f;
+    }
+
+    float decay = notorch_decay(G.notorch_decay, *b_rms);
+
+    // B[r,i] = clamp((B[r,i] + lr * x[i] * g * u[r]) * decay)
+    double ss = 0.0;
+    if (d->b_layout == AM_LAYOUT_COL) {
+        for (int i = 0; i < in_dim; i++) {
+            float xi = x[i] * lr * g;
+            float* b = d->B + (size_t)i * rank;
+            float row = 0.0f;
+            for (int r = 0; r < rank; r++) {
+                float v = notorch_clamp((b[r] + xi * u[r]) * decay);
+                b[r] = v;
+                row += v * v;
+            }
+            ss += row;
+        }
+    } else {
+        for (int r = 0; r < rank; r++) {
+            float* b = d->B + (size_t)r * in_dim;
+            float row = 0.0f;
+            for (int i = 0; i < in_dim; i++) {
+                float v = notorch_clamp((b[i] + x[i] * lr * g * u[r]) * decay);
+                b[i] = v;
+                row += v * v;
+            }
+            ss += row;
+        }
+    }
+    *b_rms = b_size ? (float)sqrt(ss / (double)b_size) : 0.0f;
+
+    // A[o,r] = clamp((A[o,r] + lr * u[r] * g * dy[o]) * decay)
+    if (d->a_layout == AM_LAYOUT_COL) {
+        for (int r = 0; r < rank; r++) {
+            float* a = d->A + (size_t)r * out_dim;
+            for (int o = 0; o < out_dim; o++)
+                a[o] = notorch_clamp((a[o] + ur[r] * dy[o]) * decay);
+        }
+    } else {
+        for (int o = 0; o < out_dim; o++) {
+            float* a = d->A + (size_t)o * rank;
+            for (int r = 0; r < rank; r++)
+                a[r] = notorch_clamp((a[r] + ur[r] * dy[o]) * decay);
+        }
+    }
+}
+
+void am_delta_learn(AM_DeltaDesc* d, const float* x, const float* dy, float signal,
+                    float* b_rms) {
+    if (!d || !d->A || !d->B || !x || !dy) return;
+    if (d->rank <= 0 || d->rank > 128) return;
+    float rms = -1.0f;   // no carried RMS: measure B on this call
+    delta_learn(d, x, dy, signal, b_rms ? b_rms : &rms);
+}
+
+// The NOTORCH matrices are the column-major factors: its A [in_dim × rank]
+// maps in → rank, its B [rank × out_dim] maps rank → out.
+void am_notorch_step_fused(float* A, float* B, int out_dim, int in_dim, int rank,
+                           const float* x, const float* dy, float signal,
+                           float* a_rms, AM_Rng* rng) {
+    if (!A || !B || !x || !dy || !a_rms) return;
+    if (rank <= 0 || rank > 128) return;
+    AM_DeltaDesc d = { out_dim, in_dim, rank, B, A, AM_LAYOUT_COL, AM_LAYOUT_COL, rng };
+    delta_learn(&d, x, dy, signal, a_rms);
 }
 
 // NOTORCH step: update low-rank delta matrices from experience
-// A: [out_dim × rank], B: [rank × in_dim]
+// A: [in_dim × rank], B: [rank × out_dim]
 // x: input hidden state [in_dim], dy: output gradient proxy [out_dim]
 // signal: teaching signal (positive = reinforce, negative = suppress)
 void am_notorch_step(float* A, float* B, int out_dim, int in_dim, int rank,
                      const float* x, const float* dy, float signal) {
-    if (!A || !B || !x || !dy) return;
+    float rms = -1.0f;   // measured from A on every call
+    am_notorch_step_fused(A, B, out_dim, in_dim, rank, x, dy, signal, &rms, NULL);
+}
+
+// Mini-batch NOTORCH: k experiences, one decay and one clamp. With
+// W[k,r] = lr * g_k * u_k[r] (channels drawn in order, as k single steps
+// would), the batch is two small GEMMs fused into the usual single pass:
+// A += X^T W and B += W^T DY. Both run on the delta row kernel with k as
+// the inner dimension (zero-padded to a multiple of 8). B goes in column
+// tiles of DY^T so each tile is transposed once for every rank row.
+#define AM_NOTORCH_TILE 256    // B columns per tile
+
+void am_notorch_step_batch(float* A, float* B, int out_dim, int in_dim, int rank,
+                           const float* X, const float* DY, const float* signals,
+                           int k, float* a_rms, AM_Rng* rng) {
+    if (!A || !B || !X || !DY || !signals || k <= 0 || !a_rms) return;
     if (rank <= 0 || rank > 128) return;
 
-    // Clamp signal
-    float g = clampf(signal, -2.0f, 2.0f);
-    float lr = G.notorch_lr;
+    int kp = (k + 7) & ~7;
+    float* Wt = (float*)calloc((size_t)kp * (rank + AM_NOTORCH_TILE + 1), sizeof(float));
+    if (!Wt) return;
+    float* DYt = Wt + (size_t)rank * kp;        // [tile × kp]
+    float* xk = DYt + (size_t)AM_NOTORCH_TILE * kp;
 
-    // Build noise-modulated channel vector u
-    // Stronger signal → cleaner channel (less noise)
-    static unsigned int seed = 42;
+    float lr = G.notorch_lr;
     float u[128];
-    for (int r = 0; r < rank; r++) {
-        float n = am_frandn(&seed);
-        float k = 0.35f + 0.65f * (1.0f - fabsf(g));
-        u[r] = n * k;
+    rng = notorch_rng(rng);
+    for (int e = 0; e < k; e++) {
+        float g = clampf(signals[e], -2.0f, 2.0f);
+        notorch_channels(u, rank, g, rng);
+        for (int r = 0; r < rank; r++) Wt[(size_t)r * kp + e] = u[r] * lr * g;
+    }
+
+    size_t a_size = (size_t)in_dim * rank;
+    if (*a_rms < 0.0f) {
+        double ss = 0.0;
+        for (size_t i = 0; i < a_size; i++) ss += (double)A[i] * A[i];
+        *a_rms = a_size ? (float)sqrt(ss / (double)a_size) : 0.0f;
     }
+    float decay = notorch_decay(G.notorch_decay, *a_rms);
 
-    // A[i,r] += lr * x[i] * u[r] * g
+    // A[i,:] = clamp((A[i,:] + W^T X[:,i]) * decay)
+    double ss = 0.0;
     for (int i = 0; i < in_dim; i++) {
-        float xi = x[i] * lr * g;
+        float* a = A + (size_t)i * rank;
+        for (int e = 0; e < k; e++) xk[e] = X[(size_t)e * in_dim + i];
+        g_lk->delta(a, Wt, xk, rank, kp, 1.0f);
+        float row = 0.0f;
         for (int r = 0; r < rank; r++) {
-            A[i * rank + r] += xi * u[r];
+            float v = notorch_clamp(a[r] * decay);
+            a[r] = v;
+            row += v * v;
         }
+        ss += row;
     }
+    *a_rms = a_size ? (float)sqrt(ss / (double)a_size) : 0.0f;
 
-    // B[r,j] += lr * u[r] * dy[j] * g
-    for (int r = 0; r < rank; r++) {
-        float ur = u[r] * lr * g;
+    // B[r,j] = clamp((B[r,j] + DY[:,j] · W[:,r]) * decay)
+    for (int j0 = 0; j0 < out_dim; j0 += AM_NOTORCH_TILE) {
+        int n = (out_dim - j0 < AM_NOTORCH_TILE) ? out_dim - j0 : AM_NOTORCH_TILE;
+        for (int e = 0; e < k; e++) {
+            const float* dy = DY + (size_t)e * out_dim + j0;
+            for (int j = 0; j < n; j++) DYt[(size_t)j * kp + e] = dy[j];
+        }
+        for (int r = 0; r < rank; r++) {
+            float* b = B + (size_t)r * out_dim + j0;
+            g_lk->delta(b, DYt, Wt + (size_t)r * kp, n, kp, 1.0f);
+            for (int j = 0; j < n; j++) b[j] = notorch_clamp(b[j] * decay);
+        }
+    }
+    free(Wt);
+}
+
+// ── quantized adapters ─────────────────────────────────────────────────────
+// Symmetric int8 / int4 with one fp32 scale per group of columns. Elements
+// are stored as one flat stream (int4: two per byte), so any run of whole
+// groups dequantizes with a single kernel call.
+
+#define AM_QROUND_SEED 0x51A7E5C0FFEEull
+
+static int qm_qmax(int type) { return (type == AM_Q_INT4) ? 7 : 127; }
+
+int am_qmatrix_init(AM_QMatrix* m, int rows, int cols, int type, int group,
+                    int with_shadow) {
+    if (!m) return -1;
+    memset(m, 0, sizeof(*m));
+    if (rows <= 0 || cols <= 0) return -1;
+    if (type != AM_Q_INT8 && type != AM_Q_INT4) return -1;
+    if (group <= 0) group = cols;
+    if (cols % group) return -1;
+
+    size_t n = (size_t)rows * cols;
+    m->rows = rows;
+    m->cols = cols;
+    m->rms = -1.0f;
+    m->round = AM_QROUND_SEED;
+    m->type = type;
+    m->group = group;
+    m->q = (uint8_t*)calloc(type == AM_Q_INT4 ? (n + 1) / 2 : n, 1);
+    m->scale = (float*)calloc(n / group, sizeof(float));
+    if (with_shadow) m->shadow = (float*)calloc(n, sizeof(float));
+    if (!m->q || !m->scale || (with_shadow && !m->shadow)) {
+        am_qmatrix_free(m);
+        return -1;
+    }
+    return 0;
+}
+
+void am_qmatrix_free(AM_QMatrix* m) {
+    if (!m) return;
+    free(m->q);
+    free(m->scale);
+    free(m->shadow);
+    memset(m, 0, sizeof(*m));
+}
+
+// Quantize src into m: nearest rounding, or stochastic (floor(v/s + u)) when
+// rng is given, which keeps repeated small updates unbiased.
+static void qm_quantize(AM_QMatrix* m, const float* src, uint64_t* rng) {
+    size_t n = (size_t)m->rows * m->cols;
+    int g = m->group, qmax = qm_qmax(m->type);
+    for (size_t k0 = 0, gi = 0; k0 < n; k0 += g, gi++) {
+        float amax = 0.0f;
+        for (int i = 0; i < g; i++) amax = fmaxf(amax, fabsf(src[k0 + i]));
+        float sc = amax / (float)qmax;
+        float inv = (amax > 0.0f) ? (float)qmax / amax : 0.0f;
+        m->scale[gi] = sc;
+        for (int i = 0; i < g; i++) {
+            float v = src[k0 + i] * inv;
+            int q = rng ? (int)floorf(v + (float)(splitmix64(rng) >> 40) * (1.0f / 16777216.0f))
+                        : (int)lrintf(v);
+            if (q > qmax) q = qmax;
+            if (q < -qmax) q = -qmax;
+            size_t k = k0 + i;
+            if (m->type == AM_Q_INT8) ((int8_t*)m->q)[k] = (int8_t)q;
+            else if (k & 1) m->q[k >> 1] = (uint8_t)((m->q[k >> 1] & 0x0F) | ((q & 15) << 4));
+            else m->q[k >> 1] = (uint8_t)((m->q[k >> 1] & 0xF0) | (q & 15));
+        }
+    }
+}
+
+void am_qmatrix_quantize(AM_QMatrix* m, const float* src, uint64_t* rng) {
+    if (!m || !m->q || !src) return;
+    if (m->shadow && m->shadow != src)
+        memcpy(m->shadow, src, (size_t)m->rows * m->cols * sizeof(float));
+    m->rms = -1.0f;
+    qm_quantize(m, src, rng);
+}
+
+// dst = elements k0 .. k0+n of the stream; k0 and n whole groups. An int4 run
+// starting mid-byte (odd group) goes through the scalar kernel.
+static void qm_deq(const AM_QMatrix* m, size_t k0, int n, float* dst) {
+    const float* sc = m->scale + k0 / m->group;
+    if (m->type == AM_Q_INT8)
+        g_lk->deq_i8((const int8_t*)m->q + k0, n, sc, m->group, dst);
+    else if (k0 & 1)
+        for (int i = 0; i < n; i++)
+            dst[i] = nib_s4(m->q + (k0 >> 1), 1 + i) * sc[i / m->group];
+    else
+        g_lk->deq_i4(m->q + (k0 >> 1), n, sc, m->group, dst);
+}
+
+void am_qmatrix_dequantize(const AM_QMatrix* m, float* dst) {
+    if (!m || !m->q || !dst) return;
+    for (int r = 0; r < m->rows; r++)
+        qm_deq(m, (size_t)r * m->cols, m->cols, dst + (size_t)r * m->cols);
+}
+
+#define AM_Q_TILE 4096    // floats dequantized per block (16 KiB)
+
+// t = B @ x, each row in whole-group chunks of at most one tile
+static int qm_matvec(const AM_QMatrix* B, const float* x, float* t, float* tile) {
+    int in_dim = B->cols;
+    int chunk = (B->group <= AM_Q_TILE) ? AM_Q_TILE / B->group * B->group : B->group;
+    float* row = (chunk <= AM_Q_TILE) ? tile : (float*)malloc((size_t)chunk * sizeof(float));
+    if (!row) return -1;
+    for (int r = 0; r < B->rows; r++) {
+        float sum = 0.0f;
+        for (int c = 0; c < in_dim; c += chunk) {
+            int len = (in_dim - c < chunk) ? in_dim - c : chunk;
+            qm_deq(B, (size_t)r * in_dim + c, len, row);
+            sum += g_lk->dot(row, x + c, len);
+        }
+        t[r] = sum;
+    }
+    if (row != tile) free(row);
+    return 0;
+}
+
+// Delta voice on quantized A (out_dim × rank) and B (rank × in_dim). Blocks
+// are dequantized into an L1 tile and fed to the fp32 delta kernels, in the
+// same eight-row blocks as am_apply_delta: the result equals am_apply_delta
+// on the dequantized matrices (bit for bit when in_dim <= AM_Q_TILE).
+void am_apply_delta_q(float* out, const AM_QMatrix* A, const AM_QMatrix* B,
+                      const float* x, float alpha) {
+    if (!out || !A || !B || !x || !A->q || !B->q || alpha == 0.0f) return;
+    int out_dim = A->rows, rank = A->cols;
+    if (B->rows != rank) return;
+
+    float tile[AM_Q_TILE], tbuf[AM_DELTA_MAX_STACK_RANK];
+    float* t = (rank <= AM_DELTA_MAX_STACK_RANK) ? tbuf
+             : (float*)malloc((size_t)rank * sizeof(float));
+    int rows = (AM_Q_TILE / rank) & ~7;
+    float* blk = (rows >= 8) ? tile : (float*)malloc((size_t)8 * rank * sizeof(float));
+    if (rows < 8) rows = 8;
+
+    if (t && blk && qm_matvec(B, x, t, tile) == 0) {
+        for (int i = 0; i < out_dim; i += rows) {
+            int m = (out_dim - i < rows) ? out_dim - i : rows;
+            qm_deq(A, (size_t)i * rank, m * rank, blk);
+            g_lk->delta(out + i, blk, t, m, rank, alpha);
+        }
+    }
+    if (blk && blk != tile) free(blk);
+    if (t && t != tbuf) free(t);
+}
+
+// NOTORCH on quantized A (in_dim × rank) and B (rank × out_dim). Matrices
+// with an fp32 shadow train the shadow and requantize to nearest; without
+// one they are widened for the step and requantized stochastically.
+
+void am_notorch_step_q(AM_QMatrix* A, AM_QMatrix* B, const float* x,
+                       const float* dy, float signal) {
+    if (!A || !B || !A->q || !B->q || !x || !dy) return;
+    int in_dim = A->rows, rank = A->cols, out_dim = B->cols;
+    if (B->rows != rank) return;
+
+    size_t na = (size_t)in_dim * rank, nb = (size_t)rank * out_dim;
+    float* fa = A->shadow ? A->shadow : (float*)malloc(na * sizeof(float));
+    float* fb = B->shadow ? B->shadow : (float*)malloc(nb * sizeof(float));
+    if (fa && fb) {
+        if (!A->shadow) am_qmatrix_dequantize(A, fa);
+        if (!B->shadow) am_qmatrix_dequantize(B, fb);
+        am_notorch_step_fused(fa, fb, out_dim, in_dim, rank, x, dy, signal,
+                              &A->rms, NULL);
+        qm_quantize(A, fa, A->shadow ? NULL : &A->round);
+        qm_quantize(B, fb, B->shadow ? NULL : &B->round);
+    }
+    if (fa && fa != A->shadow) free(fa);
+    if (fb && fb != B->shadow) free(fb);
+}
+
+// ── lazily decayed adapters ────────────────────────────────────────────────
+// The true factors are scale × stored. Decay multiplies scale; an update
+// writes delta / scale into the stored values and clamps them at 10 / scale.
+// Untouched elements need no clamp (decay only shrinks them), so rows with
+// x[i] == 0 or dy[j] == 0 are skipped and a zero signal costs O(rank).
+
+int am_adapter_init(AM_Adapter* ad, int out_dim, int in_dim, int rank,
+                    uint64_t seed) {
+    if (!ad) return -1;
+    memset(ad, 0, sizeof(*ad));
+    if (out_dim <= 0 || in_dim <= 0 || rank <= 0 || rank > 128) return -1;
+    ad->out_dim = out_dim;
+    ad->in_dim = in_dim;
+    ad->rank = rank;
+    ad->scale = 1.0f;
+    am_rng_seed(&ad->rng, seed);
+    ad->A = (float*)calloc((size_t)out_dim * rank, sizeof(float));
+    ad->B = (float*)calloc((size_t)rank * in_dim, sizeof(float));
+    ad->idx = (int*)malloc((size_t)in_dim * sizeof(int));
+    if (!ad->A || !ad->B || !ad->idx) {
+        am_adapter_free(ad);
+        return -1;
+    }
+    return 0;
+}
+
+void am_adapter_free(AM_Adapter* ad) {
+    if (!ad) return;
+    free(ad->A);
+    free(ad->B);
+    free(ad->idx);
+    memset(ad, 0, sizeof(*ad));
+}
+
+// Fold scale back into the stored values and recount Σ B² exactly.
+void am_adapter_renorm(AM_Adapter* ad) {
+    if (!ad || !ad->A) return;
+    float s = ad->scale;
+    size_t na = (size_t)ad->out_dim * ad->rank;
+    size_t nb = (size_t)ad->rank * ad->in_dim;
+    double ss = 0.0;
+    for (size_t i = 0; i < na; i++) ad->A[i] *= s;
+    for (size_t i = 0; i < nb; i++) {
+        ad->B[i] *= s;
+        ss += (double)ad->B[i] * ad->B[i];
+    }
+    ad->b_ss = ss;
+    ad->scale = 1.0f;
+}
+
+void am_adapter_load(AM_Adapter* ad, const float* A, const float* B) {
+    if (!ad || !ad->A) return;
+    size_t na = (size_t)ad->out_dim * ad->rank;
+    size_t nb = (size_t)ad->rank * ad->in_dim;
+    for (size_t i = 0; i < na; i++) ad->A[i] = A ? notorch_clamp(A[i]) : 0.0f;
+    for (size_t i = 0; i < nb; i++) ad->B[i] = B ? notorch_clamp(B[i]) : 0.0f;
+    ad->scale = 1.0f;
+    am_adapter_renorm(ad);
+}
+
+// lr / decay_base are passed in so the learner thread never reads G.
+static void adapter_step(AM_Adapter* ad, const float* x, const float* dy, float signal,
+                         float lr, float decay_base) {
+    int out_dim = ad->out_dim, in_dim = ad->in_dim, rank = ad->rank;
+
+    float g = clampf(signal, -2.0f, 2.0f);
+    float u[128];
+    notorch_channels(u, rank, g, &ad->rng);
+
+    // B here is NOTORCH's A (transposed), so its RMS drives the decay
+    size_t nb = (size_t)rank * in_dim;
+    float rms = ad->scale * (float)sqrt(ad->b_ss / (double)nb);
+    float inv = 1.0f / ad->scale;
+    ad->scale *= notorch_decay(decay_base, rms);
+    float lim = 10.0f / ad->scale;
+
+    float c = lr * g * inv;
+    if (c != 0.0f) {
+        // B[r,i] += lr * u[r] * x[i] * g, over the nonzero x[i]
+        int nnz = 0;
+        for (int i = 0; i < in_dim; i++)
+            if (x[i] != 0.0f) ad->idx[nnz++] = i;
+        double dss = 0.0;
+        for (int r = 0; r < rank; r++) {
+            float ur = u[r] * c;
+            float* b = ad->B + (size_t)r * in_dim;
+            float row = 0.0f;
+            if (nnz == in_dim) {
+                for (int i = 0; i < in_dim; i++) {
+                    float old = b[i], v = notorch_clamp_at(old + ur * x[i], lim);
+                    b[i] = v;
+                    row += v * v - old * old;
+                }
+            } else {
+                for (int k = 0; k < nnz; k++) {
+                    int i = ad->idx[k];
+                    float old = b[i], v = notorch_clamp_at(old + ur * x[i], lim);
+                    b[i] = v;
+                    row += v * v - old * old;
+                }
+            }
+            dss += row;
+        }
+        ad->b_ss += dss;
+        if (ad->b_ss < 0.0) ad->b_ss = 0.0;
+
+        // A[j,r] += lr * dy[j] * u[r] * g, over the nonzero dy[j]
         for (int j = 0; j < out_dim; j++) {
-            B[r * out_dim + j] += ur * dy[j];
+            if (dy[j] == 0.0f) continue;
+            float dj = dy[j] * c;
+            float* a = ad->A + (size_t)j * rank;
+            for (int r = 0; r < rank; r++)
+                a[r] = notorch_clamp_at(a[r] + dj * u[r], lim);
         }
     }
 
-    // Adaptive decay: stronger when delta norm is large
-    if (G.notorch_decay > 0.0f && G.notorch_decay < 1.0f) {
-        float norm = 0.0f;
-        int a_size = in_dim * rank;
-        for (int i = 0; i < a_size; i++) norm += A[i] * A[i];
-        norm = sqrtf(norm / (float)a_size);
+    if (ad->scale < AM_ADAPTER_MIN_SCALE) am_adapter_renorm(ad);
+}
+
+void am_adapter_step(AM_Adapter* ad, const float* x, const float* dy, float signal) {
+    if (!ad || !ad->A || !x || !dy) return;
+    adapter_step(ad, x, dy, signal, G.notorch_lr, G.notorch_decay);
+}
+
+// The scale enters as alpha × scale² (both factors carry it).
+void am_adapter_apply(const AM_Adapter* ad, float* out, const float* x, float alpha) {
+    if (!ad || !ad->A || !out || !x) return;
+    am_apply_delta(out, ad->A, ad->B, x, ad->out_dim, ad->in_dim, ad->rank,
+                   alpha * ad->scale * ad->scale);
+}
+
+// ── asynchronous learner ───────────────────────────────────────────────────
+// The host's adapter is the front buffer: only the inference thread touches
+// it, and only am_step / am_learner_sync replace its contents. The learner
+// trains a back copy from a single-producer ring of (x, dy, signal) records,
+// then marks it READY. The next step boundary swaps the two buffers and
+// marks it SWAPPED. The learner then copies the new front back before
+// training further. Without threads, pushes train the back copy inline; the
+// publish points stay the same.
+
+enum { LS_TRAIN, LS_READY, LS_SWAPPED };
+
+#ifdef AM_HAVE_THREADS
+  typedef atomic_uint AM_LearnCount;
+  typedef atomic_int  AM_LearnState;
+  #define learn_load(p)     atomic_load_explicit((p), memory_order_acquire)
+  #define learn_store(p, v) atomic_store_explicit((p), (v), memory_order_release)
+#else
+  typedef unsigned AM_LearnCount;
+  typedef int      AM_LearnState;
+  #define learn_load(p)     (*(p))
+  #define learn_store(p, v) (*(p) = (v))
+#endif
+
+typedef struct {
+    float* x;               // [in_dim]
+    float* dy;              // [out_dim]
+    float  signal;
+    float  lr, decay;       // NOTORCH_LR / NOTORCH_DECAY when pushed
+} AM_LearnRec;
+
+typedef struct {
+    AM_Adapter*   front;    // host-owned, read by inference
+    AM_Adapter    back;     // trained by the learner
+    AM_LearnRec   ring[AM_LEARNER_RING];
+    AM_LearnCount head;     // records pushed (producer)
+    AM_LearnCount tail;     // records consumed (learner)
+    AM_LearnState state;
+    unsigned      ready;    // records inside back when it went READY
+    unsigned      visible;  // records inside front
+    int           running;
+#ifdef AM_HAVE_THREADS
+    pthread_t       th;
+    pthread_mutex_t mu;
+    pthread_cond_t  wake;
+    atomic_int      sleeping;
+    int             quit;
+#endif
+} AM_Learner;
+
+static AM_Learner g_learn = {
+#ifdef AM_HAVE_THREADS
+    .mu = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+#endif
+    .running = 0,
+};
+
+static void adapter_copy(AM_Adapter* dst, const AM_Adapter* src) {
+    memcpy(dst->A, src->A, (size_t)src->out_dim * src->rank * sizeof(float));
+    memcpy(dst->B, src->B, (size_t)src->rank * src->in_dim * sizeof(float));
+    dst->scale = src->scale;
+    dst->b_ss = src->b_ss;
+    dst->rng = src->rng;
+}
+
+// Learner side: train back on everything queued. Returns 1 if it did work.
+static int learner_drain(AM_Learner* L) {
+    int st = learn_load(&L->state);
+    if (st == LS_READY) return 0;
+    if (st == LS_SWAPPED) {
+        adapter_copy(&L->back, L->front);
+        learn_store(&L->state, LS_TRAIN);
+    }
+    unsigned tail = learn_load(&L->tail), head = learn_load(&L->head);
+    if (tail == head) return 0;
+    for (; tail != head; tail++) {
+        AM_LearnRec* r = &L->ring[tail % AM_LEARNER_RING];
+        adapter_step(&L->back, r->x, r->dy, r->signal, r->lr, r->decay);
+        learn_store(&L->tail, tail + 1);   // frees the slot
+    }
+    L->ready = head;
+    learn_store(&L->state, LS_READY);
+    return 1;
+}
+
+// Inference side: swap a READY back buffer in as the front.
+static void learner_publish(void) {
+    AM_Learner* L = &g_learn;
+    if (!L->running || learn_load(&L->state) != LS_READY) return;
+    AM_Adapter t = *L->front;
+    *L->front = L->back;
+    L->back = t;
+    L->visible = L->ready;
+    learn_store(&L->state, LS_SWAPPED);
+#ifdef AM_HAVE_THREADS
+    atomic_thread_fence(memory_order_seq_cst);   // pairs with the learner's sleeping flag
+    if (atomic_load(&L->sleeping)) {
+        pthread_mutex_lock(&L->mu);
+        pthread_cond_signal(&L->wake);
+        pthread_mutex_unlock(&L->mu);
+    }
+#endif
+}
+
+#ifdef AM_HAVE_THREADS
+static int learner_idle(AM_Learner* L) {
+    int st = learn_load(&L->state);
+    return st == LS_READY || (st == LS_TRAIN && learn_load(&L->tail) == learn_load(&L->head));
+}
 
-        float adaptive_decay = G.notorch_decay - 0.004f * fminf(norm / 10.0f, 1.0f);
-        if (adaptive_decay < 0.990f) adaptive_decay = 0.990f;
+static void* learner_main(void* p) {
+    AM_Learner* L = (AM_Learner*)p;
+    for (;;) {
+        if (learner_drain(L)) continue;
+        pthread_mutex_lock(&L->mu);
+        atomic_store(&L->sleeping, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        while (!L->quit && learner_idle(L))
+            pthread_cond_wait(&L->wake, &L->mu);
+        atomic_store(&L->sleeping, 0);
+        int quit = L->quit;
+        pthread_mutex_unlock(&L->mu);
+        if (quit) return NULL;
+    }
+}
+#endif
 
-        for (int i = 0; i < a_size; i++) A[i] *= adaptive_decay;
-        int b_size = rank * out_dim;
-        for (int i = 0; i < b_size; i++) B[i] *= adaptive_decay;
+static void learner_release(AM_Learner* L) {
+    for (int i = 0; i < AM_LEARNER_RING; i++) {
+        free(L->ring[i].x);
+        free(L->ring[i].dy);
+        L->ring[i].x = L->ring[i].dy = NULL;
     }
+    am_adapter_free(&L->back);
+    L->front = NULL;
+}
+
+int am_learner_start(AM_Adapter* ad) {
+    AM_Learner* L = &g_learn;
+    if (L->running || !ad || !ad->A) return -1;
+    if (am_adapter_init(&L->back, ad->out_dim, ad->in_dim, ad->rank, 0) != 0) return -1;
+    adapter_copy(&L->back, ad);
+    L->front = ad;
+    int ok = 1;
+    for (int i = 0; i < AM_LEARNER_RING; i++) {
+        L->ring[i].x = (float*)malloc((size_t)ad->in_dim * sizeof(float));
+        L->ring[i].dy = (float*)malloc((size_t)ad->out_dim * sizeof(float));
+        if (!L->ring[i].x || !L->ring[i].dy) ok = 0;
+    }
+    learn_store(&L->head, 0u);
+    learn_store(&L->tail, 0u);
+    learn_store(&L->state, LS_TRAIN);
+    L->ready = L->visible = 0;
+#ifdef AM_HAVE_THREADS
+    L->quit = 0;
+    atomic_store(&L->sleeping, 0);
+    if (ok && pthread_create(&L->th, NULL, learner_main, L) != 0) ok = 0;
+#endif
+    if (!ok) { learner_release(L); return -1; }
+    L->running = 1;
+    return 0;
+}
 
-    // Clamp to prevent runaway
-    int a_size = in_dim * rank;
-    for (int i = 0; i < a_size; i++) {
-        if (A[i] > 10.0f) A[i] = 10.0f;
-        if (A[i] < -10.0f) A[i] = -10.0f;
+int am_learner_push(const float* x, const float* dy, float signal) {
+    AM_Learner* L = &g_learn;
+    if (!L->running || !x || !dy) return -1;
+    unsigned head = learn_load(&L->head);
+    if (head - learn_load(&L->tail) >= AM_LEARNER_RING) return -1;   // full: dropped
+    AM_LearnRec* r = &L->ring[head % AM_LEARNER_RING];
+    memcpy(r->x, x, (size_t)L->back.in_dim * sizeof(float));
+    memcpy(r->dy, dy, (size_t)L->back.out_dim * sizeof(float));
+    r->signal = signal;
+    r->lr = G.notorch_lr;
+    r->decay = G.notorch_decay;
+#ifdef AM_HAVE_THREADS
+    atomic_store(&L->head, head + 1);
+    if (atomic_load(&L->sleeping)) {
+        pthread_mutex_lock(&L->mu);
+        pthread_cond_signal(&L->wake);
+        pthread_mutex_unlock(&L->mu);
     }
-    int b_size = rank * out_dim;
-    for (int i = 0; i < b_size; i++) {
-        if (B[i] > 10.0f) B[i] = 10.0f;
-        if (B[i] < -10.0f) B[i] = -10.0f;
+#else
+    L->head = head + 1;
+    learner_drain(L);
+#endif
+    return 0;
+}
+
+void am_learner_sync(void) {
+    AM_Learner* L = &g_learn;
+    if (!L->running) return;
+    while (L->visible != learn_load(&L->head)) {
+        learner_publish();
+#ifdef AM_HAVE_THREADS
+        sched_yield();
+#else
+        learner_drain(L);
+#endif
     }
 }
 
+void am_learner_stop(void) {
+    AM_Learner* L = &g_learn;
+    if (!L->running) return;
+    am_learner_sync();
+#ifdef AM_HAVE_THREADS
+    pthread_mutex_lock(&L->mu);
+    L->quit = 1;
+    pthread_cond_signal(&L->wake);
+    pthread_mutex_unlock(&L->mu);
+    pthread_join(L->th, NULL);
+#endif
+    L->running = 0;
+    learner_release(L);
+}
+
 // ═══════════════════════════════════════════════════════════════════════════════
 // BLOOD — runtime C compilation (Level 3)
 //
@@ -2716,6 +6259,7 @@ int am_blood_compile_emotion(const char* name, float valence, float arousal) {
 // ═══════════════════════════════════════════════════════════════════════════════
 
 void am_step(float dt) {
+  learner_publish();   // step boundary: pick up the learner's latest adapter
   if (dt <= 0.0f) return;
 
   // ─────────────────────────────────────────────────────────────────────────────
@@ -2945,4 +6489,7 @@ void am_step(float dt) {
           G.winter_energy * 0.005f * dt);
     }
   }
+
+  // freeze this step's logit transform
+  am_field_plan_build();
 }
@@ -18,8 +18,9 @@
 #ifndef ARIANNAMETHOD_H
 #define ARIANNAMETHOD_H
 
-#include <stdlib.h>  // for rand(), RAND_MAX
+#include <stdlib.h>
 #include <math.h>    // for fabsf, sinf, sqrtf, fmaxf, fminf, expf
+#include <stdint.h>  // for uint16_t (half-precision logits)
 
 #ifdef __cplusplus
 extern "C" {
@@ -223,6 +224,11 @@ typedef struct {
   int   janus_b;            // secondary face (index into gamma[])
   float janus_blend;        // blend ratio: 0=face_a only, 1=face_b only
   float gamma_drift;        // how fast janus_blend changes per step
+
+  // TOKEN ACCOUNTING — am_commit_token
+  float last_debt;          // prophecy debt of the last committed token
+  int   tokens_committed;   // tokens committed since am_init
+  int   wormhole_tokens;    // ... of those, committed while a wormhole was open
 } AM_State;
 
 // Temporal modes
@@ -236,7 +242,6 @@ typedef struct {
 
 #define AML_MAX_LINES       1024
 #define AML_MAX_LINE_LEN    256
-#define AML_MAX_VARS        64
 #define AML_MAX_NAME        32
 #define AML_MAX_FUNCS       64    // increased: 32 user + 32 built-in
 #define AML_MAX_PARAMS      8
@@ -250,17 +255,12 @@ typedef struct {
     int  lineno;
 } AML_Line;
 
-// Variable
-typedef struct {
-    char  name[AML_MAX_NAME];
-    float value;
-} AML_Var;
-
-// Symbol table
+// Variable frame: one slot per variable name in the program, allocated on
+// first use of its call depth. No fixed variable limit.
 typedef struct {
-    AML_Var vars[AML_MAX_VARS];
-    int     count;
-} AML_Symtab;
+    float*   val;
+    uint8_t* set;       // slot assigned in this frame
+} AML_Frame;
 
 // User-defined function
 typedef struct {
@@ -282,13 +282,16 @@ typedef struct {
 typedef struct {
     AML_Line*    lines;
     int          nlines;
-    AML_Symtab   globals;
-    AML_Symtab   locals[AML_MAX_CALL_DEPTH];
+    AML_Frame    frames[AML_MAX_CALL_DEPTH + 1];  // [0] globals, [d] call depth d
+    int          nslots;        // slots per frame
     int          call_depth;
     AML_Functab  funcs;
     int          include_depth;
     char         base_dir[256];
     char         error[256];
+    const char*  arg_text;      // Level 0 argument the VM already evaluated
+    float        arg_value;     // ... to this value
+    struct AML_Program* prog;   // compiled program running in this context
 } AML_ExecCtx;
 
 // AM_State field map entry (for reading state in expressions)
@@ -323,10 +326,92 @@ int am_exec_file(const char* path);
 // Get last error from am_exec (empty string = no error)
 const char* am_get_error(void);
 
+// Compiled scripts: preprocess, register functions and compile expressions
+// once, then run many times. am_run(p) behaves exactly like am_exec(script);
+// variables start empty on every run. NULL from am_compile = out of memory.
+typedef struct AML_Program AML_Program;
+AML_Program* am_compile(const char* script);
+int          am_run(AML_Program* prog);
+void         am_program_free(AML_Program* prog);
+
+// Level 0 command IDs (am_cmd_id / am_exec_cmd). IMPORT is an alias of MODE.
+#define AM_CMD_PROPHECY             0
+#define AM_CMD_DESTINY              1
+#define AM_CMD_WORMHOLE             2
+#define AM_CMD_CALENDAR_DRIFT       3
+#define AM_CMD_ATTEND_FOCUS         4
+#define AM_CMD_ATTEND_SPREAD        5
+#define AM_CMD_TUNNEL_THRESHOLD     6
+#define AM_CMD_TUNNEL_CHANCE        7
+#define AM_CMD_TUNNEL_SKIP_MAX      8
+#define AM_CMD_PAIN                 9
+#define AM_CMD_TENSION              10
+#define AM_CMD_DISSONANCE           11
+#define AM_CMD_PROPHECY_DEBT        12
+#define AM_CMD_PROPHECY_DEBT_DECAY  13
+#define AM_CMD_JUMP                 14
+#define AM_CMD_VELOCITY             15
+#define AM_CMD_BASE_TEMP            16
+#define AM_CMD_RESET_FIELD          17
+#define AM_CMD_RESET_DEBT           18
+#define AM_CMD_LAW                  19
+#define AM_CMD_MODE                 20
+#define AM_CMD_DISABLE              21
+#define AM_CMD_CHORDLOCK            22
+#define AM_CMD_TEMPOLOCK            23
+#define AM_CMD_CHIRALITY            24
+#define AM_CMD_TEMPO                25
+#define AM_CMD_PAS_THRESHOLD        26
+#define AM_CMD_ANCHOR               27
+#define AM_CMD_GRAVITY              28
+#define AM_CMD_ANTIDOTE             29
+#define AM_CMD_SCAR                 30
+#define AM_CMD_SCHUMANN             31
+#define AM_CMD_SCHUMANN_MODULATION  32
+#define AM_CMD_COSMIC_COHERENCE     33
+#define AM_CMD_LORA_ALPHA           34
+#define AM_CMD_NOTORCH_LR           35
+#define AM_CMD_NOTORCH_DECAY        36
+#define AM_CMD_RESONANCE_BOOST      37
+#define AM_CMD_SEASON               38
+#define AM_CMD_SEASON_INTENSITY     39
+#define AM_CMD_GAMMA                40
+#define AM_CMD_GAMMA_UNLOAD         41
+#define AM_CMD_ESSENCE              42
+#define AM_CMD_JANUS                43
+#define AM_CMD_JANUS_BLEND          44
+#define AM_CMD_GAMMA_DRIFT          45
+#define AM_CMD_ECHO                 46
+#define AM_CMD_TEMPORAL_MODE        47
+#define AM_CMD_TEMPORAL_ALPHA       48
+#define AM_CMD_RTL_MODE             49
+#define AM_CMD_PROPHECY_MODE        50
+#define AM_CMD_RETRODICTION_MODE    51
+#define AM_CMD_EXPERT_STRUCTURAL    52
+#define AM_CMD_EXPERT_SEMANTIC      53
+#define AM_CMD_EXPERT_CREATIVE      54
+#define AM_CMD_EXPERT_PRECISE       55
+#define AM_CMD_PRESENCE_DECAY       56
+#define AM_CMD_MACRO                57
+#define AM_CMD_BLOOD                58
+#define AM_CMD_COUNT                59
+
+// Resolve a command name once (-1 = unknown, case-insensitive), then execute
+// by id without any name lookup. Arguments are plain Level 0 text, as in
+// am_exec outside Level 2 (no expressions). Returns 1 for a bad id.
+int am_cmd_id(const char* name);
+int am_exec_cmd(int id, const char* arg);
+
 // State access
 AM_State* am_get_state(void);
 int am_take_jump(void);
 
+// Readable fields by id: resolve a name once (case-insensitive, -1 = unknown),
+// then poll without any lookup. Names are the ones expressions see (PAIN,
+// entropy, ...); int fields read as float. A bad id reads 0.
+int   am_field_id(const char* name);
+float am_get_field_by_id(int id);
+
 // Copy state to float array (32 floats)
 int am_copy_state(float* out);
 
@@ -352,6 +437,10 @@ int am_gamma_active(void);
 // Get blended gamma alpha (considering janus mode).
 float am_gamma_get_blend(void);
 
+// Per-slot share of the blend: w[AM_MAX_GAMMA], summing to am_gamma_get_blend().
+// Janus DUAL/CYCLE splits it between the two faces by janus_blend.
+void am_gamma_slot_weights(float* w);
+
 // Set janus mode: dual-facing field.
 void am_janus_set(const char* face_a, const char* face_b);
 
@@ -375,18 +464,228 @@ void am_apply_attention_to_logits(float* logits, int n);
 // Apply all laws: entropy floor, resonance ceiling
 void am_apply_laws_to_logits(float* logits, int n);
 
+// Counter-based random streams: draw i is a hash of (key, i), so streams
+// share no state and take no lock, and a run of draws is one SIMD pass.
+// Give each thread / adapter its own AM_Rng.
+typedef struct {
+    uint64_t key;   // from the seed
+    uint64_t ctr;   // draws taken
+} AM_Rng;
+
+void  am_rng_seed(AM_Rng* g, uint64_t seed);
+float am_rng_uniform(AM_Rng* g);                  // [0, 1), 24-bit
+void  am_rng_fill(AM_Rng* g, float* out, int n);  // = n am_rng_uniform calls
+
 // Apply delta voice: logits += lora_alpha * A @ (B @ hidden_state)
 // (host provides A, B matrices and hidden state)
+// A is out_dim × rank, B is rank × in_dim, both row-major. Ranks 4/8/16/32/64
+// run specialised SIMD kernels; ranks above AM_DELTA_MAX_STACK_RANK allocate.
+#define AM_DELTA_MAX_STACK_RANK 128
 void am_apply_delta(float* out, const float* A, const float* B,
                     const float* x, int out_dim, int in_dim, int rank,
                     float alpha);
 
+// Same, with caller-provided scratch of at least rank floats (any rank,
+// no allocation)
+void am_apply_delta_scratch(float* out, const float* A, const float* B,
+                            const float* x, int out_dim, int in_dim, int rank,
+                            float alpha, float* scratch);
+
+// Batched delta voice over [batch × out_dim] outputs and [batch × in_dim]
+// hidden states: out[b] += alphas[b] * A @ (B @ X[b]). A and B are streamed
+// once per batch instead of once per sequence. alphas NULL = 1 for all rows.
+// Each row comes out exactly as am_apply_delta leaves it.
+void am_apply_delta_batch(float* out, const float* A, const float* B,
+                          const float* X, int batch, int out_dim, int in_dim,
+                          int rank, const float* alphas);
+
+// Stacked adapters: N low-rank deltas packed so one pass over x and out
+// applies all of them. B_k are stacked into one [rank × in_dim] matrix (rank =
+// sum of adapter ranks), A_k side by side into [out_dim × rank]. Adapter k is
+// gamma slot k when alphas come from the field.
+typedef struct {
+    int    n_adapters;
+    int    out_dim, in_dim;
+    int    rank;                        // sum of adapter ranks
+    int    offset[AM_MAX_GAMMA + 1];    // adapter k: components offset[k]..offset[k+1]
+    float* A;                           // out_dim × rank
+    float* B;                           // rank × in_dim
+} AM_DeltaStack;
+
+// Pack n <= AM_MAX_GAMMA adapters (A[k]: out_dim × ranks[k], B[k]: ranks[k] ×
+// in_dim). A rank of 0 leaves that slot empty. Returns 0, or -1 on bad
+// arguments / allocation failure.
+int  am_delta_stack_init(AM_DeltaStack* s, int n, const float* const* A,
+                         const float* const* B, const int* ranks,
+                         int out_dim, int in_dim);
+void am_delta_stack_free(AM_DeltaStack* s);
+
+// out += sum_k alphas[k] * A_k @ (B_k @ x). alphas NULL = the plan's gamma
+// slot weights (the gamma/janus blend, see am_gamma_slot_weights).
+void am_apply_delta_stack(float* out, const AM_DeltaStack* s, const float* x,
+                          const float* alphas);
+
+// Adapter descriptor: one low-rank delta out += alpha * A @ (B @ x) with the
+// storage order of each factor recorded, so apply and learn work on the same
+// memory. AM_LAYOUT_ROW is am_apply_delta's layout (A [out_dim × rank],
+// B [rank × in_dim]); AM_LAYOUT_COL stores a factor transposed, which is
+// NOTORCH's layout (its A is this B, its B is this A).
+#define AM_LAYOUT_ROW 0
+#define AM_LAYOUT_COL 1
+
+typedef struct {
+    int    out_dim, in_dim, rank;
+    float* A;           // rank → out: ROW A[o·rank + r], COL A[r·out_dim + o]
+    float* B;           // in → rank:  ROW B[r·in_dim + i], COL B[i·rank + r]
+    int    a_layout;    // AM_LAYOUT_ROW / AM_LAYOUT_COL
+    int    b_layout;
+    AM_Rng* rng;        // NOTORCH channels; NULL = the calling thread's stream
+} AM_DeltaDesc;
+
+// out += alpha * A @ (B @ x), each factor walked in its storage order.
+void am_delta_apply(float* out, const AM_DeltaDesc* d, const float* x, float alpha);
+
+// Quantized adapter storage: symmetric int8 / int4 with one fp32 scale per
+// group of columns (group must divide cols; <= 0 = one scale per row).
+#define AM_Q_INT8  0
+#define AM_Q_INT4  1    // two's-complement nibbles, two per byte
+
+typedef struct {
+    int      rows, cols;    // logical shape, row-major
+    int      type;          // AM_Q_INT8 / AM_Q_INT4
+    int      group;         // columns per scale
+    uint8_t* q;             // rows × cols values as one stream
+    float*   scale;         // rows × (cols / group)
+    float*   shadow;        // fp32 master for NOTORCH, or NULL
+    float    rms;           // NOTORCH: RMS carried between steps (< 0 = unmeasured)
+    uint64_t round;         // NOTORCH: stochastic rounding state (no shadow)
+} AM_QMatrix;
+
+// Returns 0, or -1 on bad shape / allocation failure. with_shadow keeps an
+// fp32 copy that am_notorch_step_q trains (memory of the fp32 matrix).
+int  am_qmatrix_init(AM_QMatrix* m, int rows, int cols, int type, int group,
+                     int with_shadow);
+// Quantize src (and copy it to the shadow). rng NULL rounds to nearest; a
+// caller-owned seed rounds stochastically (unbiased, advanced in place).
+void am_qmatrix_quantize(AM_QMatrix* m, const float* src, uint64_t* rng);
+void am_qmatrix_dequantize(const AM_QMatrix* m, float* dst);
+void am_qmatrix_free(AM_QMatrix* m);
+
+// am_apply_delta on quantized A (out_dim × rank) and B (rank × in_dim),
+// dequantized on the fly in L1-sized SIMD blocks
+void am_apply_delta_q(float* out, const AM_QMatrix* A, const AM_QMatrix* B,
+                      const float* x, float alpha);
+
 // Compute prophecy debt from chosen token (retroactive)
 float am_compute_prophecy_debt(const float* logits, int chosen, int n);
 
 // Full pipeline: apply all field effects to logits
 void am_apply_field_to_logits(float* logits, int n);
 
+// Field parameters the logit pipeline reads — one snapshot per sequence.
+typedef struct {
+    float gamma_blend;        // am_gamma_get_blend()
+    float essence_alpha;      // γ injection strength
+    float destiny_bias;       // prophecy-scaled destiny (computed in am_step)
+    float pain;               // suffering compression
+    float attend_focus;       // attention sharpening
+    float attend_spread;      // attention blur
+    float entropy_floor;      // laws: max top-1 gap
+    float resonance_ceiling;  // laws: top probability cap
+    float temperature;        // effective_temp (am_sample_field)
+} AM_FieldParams;
+
+// Snapshot the current field into p
+void am_field_params_capture(AM_FieldParams* p);
+
+// Batched pipeline over a [rows × n] tile, rows row_stride floats apart.
+// params: one entry per row, or NULL to apply the current field to all rows.
+void am_apply_field_to_logits_batch(float* logits, int rows, int n,
+                                    int row_stride, const AM_FieldParams* params);
+
+// Per-step logit plan: the field resolved into scales and a stage mask.
+// Rebuilt by am_init, am_step, am_exec, am_reset_field and the gamma/janus
+// calls; hosts that write AM_State directly call am_field_plan_build().
+// The fused pipelines read only this plan.
+#define AM_PLAN_GAMMA      0x01
+#define AM_PLAN_DESTINY    0x02
+#define AM_PLAN_SUFFERING  0x04
+#define AM_PLAN_ATTENTION  0x08
+#define AM_PLAN_FLOOR      0x10    // laws: entropy floor
+#define AM_PLAN_CEILING    0x20    // laws: resonance ceiling
+
+typedef struct {
+    unsigned int stages;       // AM_PLAN_* bits; 0 = field is a no-op
+    float gamma_blend;         // am_gamma_get_blend() at build time
+    float gamma_k;             // x' = mean + (x - mean) * gamma_k
+    float destiny_h;           // x' = x - (max - x) * destiny_h
+    float pain_k;              // x' = mean + (x - mean) * pain_k
+    float attend_k;            // x' = mean + (x - mean) * attend_k
+    float entropy_floor;
+    float resonance_ceiling;
+    float inv_temp;            // 1 / effective_temp
+    float gamma_w[AM_MAX_GAMMA];  // am_gamma_slot_weights() at build time
+} AM_FieldPlan;
+
+void am_field_plan_build(void);
+const AM_FieldPlan* am_field_plan(void);
+
+// Fused sampler: field transforms + effective_temp + softmax + sampling in
+// two passes over the row. logits are left as am_apply_field_to_logits
+// leaves them; rng_state is any caller-owned 64-bit seed, advanced in place.
+// Returns the prophecy debt of the sampled token, stored in *chosen.
+float am_sample_field(float* logits, int n, uint64_t* rng_state, int* chosen);
+
+// Commit the host's chosen token: O(1) prophecy debt against the row last
+// passed through am_apply_field_to_logits / _bf16 / _fp16 / _candidates or
+// am_sample_field (its max is cached by the field pass), then debt += it,
+// tension builds, last_debt / tokens_committed / wormhole_tokens update.
+// chosen indexes that row; the row must not be rewritten in between.
+float am_commit_token(int chosen);
+
+// Sparse candidate mode: run the field over a shortlist (e.g. the sampler's
+// top-k) in O(k). values must contain the two largest logits of the full
+// vocabulary; vocab_mean is am_logit_mean() of it (or the engine's own).
+// Each value ends up equal to what the dense pipeline gives that token.
+void  am_apply_field_to_candidates(float* values, int k, float vocab_mean);
+float am_logit_mean(const float* logits, int n);
+
+#define AM_FIELD_MAX_THREADS    16       // pool size cap (caller included)
+#define AM_FIELD_THREAD_MIN_N   65536    // default serial cutoff (logits/row)
+
+// Threaded field pipeline: shard each row over a persistent pool of
+// nthreads (the caller is one of them) when n >= min_n (<= 0: default).
+// nthreads <= 1 stops the pool. Returns the thread count in use.
+int am_field_threads(int nthreads, int min_n);
+
+// Half-precision logits (raw bf16 / IEEE fp16 bits). Same pipeline as the
+// float version: stats accumulate in fp32, the rewrite rounds to nearest-even.
+void  am_apply_field_to_logits_bf16(uint16_t* logits, int n);
+void  am_apply_field_to_logits_fp16(uint16_t* logits, int n);
+float am_compute_prophecy_debt_bf16(const uint16_t* logits, int chosen, int n);
+float am_compute_prophecy_debt_fp16(const uint16_t* logits, int chosen, int n);
+float    am_bf16_to_float(uint16_t h);
+uint16_t am_float_to_bf16(float f);
+float    am_fp16_to_float(uint16_t h);
+uint16_t am_float_to_fp16(float f);
+
+// ═══════════════════════════════════════════════════════════════════════════════
+// SIMD — logit kernels, chosen at load time by CPU feature detection
+// ═══════════════════════════════════════════════════════════════════════════════
+
+#define AM_SIMD_SCALAR  0   // portable C
+#define AM_SIMD_NEON    1   // aarch64
+#define AM_SIMD_AVX2    2   // x86, 8 lanes
+#define AM_SIMD_AVX512  3   // x86, 16 lanes
+
+// Active kernel level / name ("scalar", "neon", "avx2", "avx512")
+int am_simd_level(void);
+const char* am_simd_name(void);
+
+// Force a kernel level (for testing/benchmarks). Falls back to the best
+// level at or below the request that this CPU supports. Returns the level.
+int am_simd_set(int level);
+
 // ═══════════════════════════════════════════════════════════════════════════════
 // NOTORCH — Hebbian plasticity without PyTorch
 // ═══════════════════════════════════════════════════════════════════════════════
@@ -395,9 +694,82 @@ void am_apply_field_to_logits(float* logits, int n);
 // A: [in_dim × rank], B: [rank × out_dim]
 // x: input [in_dim], dy: output gradient proxy [out_dim]
 // signal: teaching signal (positive = reinforce, negative = suppress)
+// Channels come from the calling thread's stream, reseeded by am_init.
 void am_notorch_step(float* A, float* B, int out_dim, int in_dim, int rank,
                      const float* x, const float* dy, float signal);
 
+// Same step with the carried RMS of A owned by the caller: one pass over A
+// and one over B (update, decay, clamp). Set *a_rms < 0 to measure it first.
+// rng draws the channels; NULL uses the calling thread's stream.
+void am_notorch_step_fused(float* A, float* B, int out_dim, int in_dim, int rank,
+                           const float* x, const float* dy, float signal,
+                           float* a_rms, AM_Rng* rng);
+
+// am_notorch_step on a descriptor, in place for either layout (x is the
+// input, dy the output proxy). b_rms carries the RMS of B between steps as
+// in am_notorch_step_fused; NULL measures B on every call.
+void am_delta_learn(AM_DeltaDesc* d, const float* x, const float* dy, float signal,
+                    float* b_rms);
+
+// k experiences in one call: X [k × in_dim], DY [k × out_dim], signals [k].
+// Channels are drawn as k am_notorch_step calls would draw them, the k
+// updates are summed, and decay and clamp are applied once for the batch.
+// a_rms and rng are as in am_notorch_step_fused.
+void am_notorch_step_batch(float* A, float* B, int out_dim, int in_dim, int rank,
+                           const float* X, const float* DY, const float* signals,
+                           int k, float* a_rms, AM_Rng* rng);
+
+// NOTORCH on quantized A (in_dim × rank) and B (rank × out_dim). A matrix with
+// a shadow trains it in fp32 and requantizes to nearest; without one it is
+// widened for the step and requantized with stochastic rounding drawn from
+// the matrix's own round state, so matrices can train on separate threads.
+void am_notorch_step_q(AM_QMatrix* A, AM_QMatrix* B, const float* x,
+                       const float* dy, float signal);
+
+// NOTORCH adapter with lazy decay. A [out_dim × rank] and B [rank × in_dim]
+// are kept in am_apply_delta layout (NOTORCH's B and A, transposed) and the
+// true factors are scale × stored: decay folds into scale in O(1) and the
+// matrices are renormalized only once scale falls below AM_ADAPTER_MIN_SCALE.
+#define AM_ADAPTER_MIN_SCALE 1e-3f
+
+typedef struct {
+    int    out_dim, in_dim, rank;
+    float* A;         // [out_dim × rank], stored units
+    float* B;         // [rank × in_dim], stored units
+    float  scale;     // true factors = scale × stored
+    double b_ss;      // Σ B² in stored units (drives the adaptive decay)
+    AM_Rng rng;       // channel stream (seeded by am_adapter_init)
+    int*   idx;       // scratch: nonzero positions of x
+} AM_Adapter;
+
+// Zero-filled adapter whose channel stream starts from seed (give each
+// adapter its own). Returns 0, or -1 on bad shape (rank <= 128) / OOM.
+int  am_adapter_init(AM_Adapter* ad, int out_dim, int in_dim, int rank,
+                     uint64_t seed);
+// Copy A and B in (clamped to ±10; NULL = zeros) and reset scale to 1.
+void am_adapter_load(AM_Adapter* ad, const float* A, const float* B);
+// am_notorch_step on the adapter: same channels, decay and clamp.
+void am_adapter_step(AM_Adapter* ad, const float* x, const float* dy, float signal);
+// out += alpha × A @ (B @ x) with the scale folded into alpha.
+void am_adapter_apply(const AM_Adapter* ad, float* out, const float* x, float alpha);
+// Fold scale into the stored matrices (scale becomes 1).
+void am_adapter_renorm(AM_Adapter* ad);
+void am_adapter_free(AM_Adapter* ad);
+
+// Asynchronous NOTORCH learner for one adapter. am_learner_push copies
+// (x, dy, signal) into a lock-free ring. A background thread trains a shadow
+// copy of the adapter, and each am_step swaps the latest trained buffers
+// into ad (so ad->A / ad->B change there). Between step boundaries ad stays
+// stable for am_adapter_apply. All
+// calls below, and am_step, belong to the inference thread.
+#define AM_LEARNER_RING 16      // records in flight
+
+int  am_learner_start(AM_Adapter* ad);   // 0, or -1 (running / bad adapter / OOM)
+// Returns 0, or -1 when the ring is full (the record is dropped).
+int  am_learner_push(const float* x, const float* dy, float signal);
+void am_learner_sync(void);   // block until every pushed record is in ad
+void am_learner_stop(void);   // sync, then join the thread
+
 // ═══════════════════════════════════════════════════════════════════════════════
 // BLOOD — runtime C compilation (Level 3)
 //
@@ -467,12 +839,12 @@ static inline float am_get_destiny_bias(void) {
     return s->destiny_bias;
 }
 
-// Check if tunneling should occur
+// Check if tunneling should occur. The roll comes from rng, or with NULL
+// from the calling thread's own stream (reseeded by am_init).
+int am_should_tunnel_rng(AM_Rng* rng);
+
 static inline int am_should_tunnel(void) {
-    AM_State* s = am_get_state();
-    if (s->dissonance < s->tunnel_threshold) return 0;
-    float r = (float)rand() / (float)RAND_MAX;
-    return r < s->tunnel_chance;
+    return am_should_tunnel_rng(NULL);
 }
 
 // Check if wormhole fired this step
@@ -0,0 +1,345 @@
+// bench_aml.c — logit pipeline benchmarks, JSON on stdout
+// cc -O2 bench_aml.c ariannamethod.c -o bench_aml -lm -pthread && ./bench_aml
+//
+//   bench_aml [--all-simd] [--threads N] [--reps N]
+//
+// Every am_apply_* stage and the full pipeline, at vocab 32k / 128k / 256k,
+// under several field configurations. Each row is refreshed from a master
+// copy before every call (outside the timed region) so the field never
+// compounds. Reported per call (= per generated token): median ns, GB/s over
+// the bytes the call moves with every stage on (nominal: a stage the plan
+// skips still counts), and TSC cycles per element on x86 (reference cycles,
+// not core clocks; null elsewhere).
+
+#include "ariannamethod.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+static inline unsigned long long bench_tsc(void) { return __rdtsc(); }
+#else
+#define BENCH_HAVE_TSC 0
+static inline unsigned long long bench_tsc(void) { return 0; }
+#endif
+
+#define BENCH_MAX_REPS   1000
+#define BENCH_BATCH_ROWS 8
+#define BENCH_TOPK       64
+#define BENCH_DELTA_IN   1024
+#define BENCH_DELTA_RANK 16
+
+static const int g_vocab[] = { 32768, 131072, 262144 };
+#define N_VOCAB (int)(sizeof(g_vocab) / sizeof(g_vocab[0]))
+
+// Field configurations, applied after am_init. The resulting plan stage
+// mask is reported with every result.
+static const struct { const char* name; const char* script; int step; } g_config[] = {
+    { "identity", "ATTEND_FOCUS 0.5\nATTEND_SPREAD 0.5\n"
+                  "LAW ENTROPY_FLOOR 0\nLAW RESONANCE_CEILING 1", 0 },
+    { "default",  "", 0 },
+    { "prophecy", "PROPHECY 12\nDESTINY 0.7\nATTEND_FOCUS 0.85", 1 },
+    { "full",     "GAMMA yent 0.8\nESSENCE 0.9\nPROPHECY 12\nDESTINY 0.7\n"
+                  "PAIN 0.6\nTENSION 0.5\nATTEND_FOCUS 0.9\nATTEND_SPREAD 0.1", 1 },
+};
+#define N_CONFIG (int)(sizeof(g_config) / sizeof(g_config[0]))
+
+enum {
+    B_GAMMA, B_DESTINY, B_SUFFERING, B_ATTENTION, B_LAWS, B_STAGED,
+    B_FIELD, B_FIELD_BF16, B_FIELD_FP16, B_FIELD_BATCH, B_CANDIDATES,
+    B_SAMPLE, B_DEBT, B_COMMIT, B_MEAN, B_DELTA, B_DELTA_BATCH, B_NOTORCH,
+    B_COUNT
+};
+
+static const char* g_bench_name[B_COUNT] = {
+    "gamma", "destiny", "suffering", "attention", "laws", "staged",
+    "field", "field_bf16", "field_fp16", "field_batch", "candidates",
+    "sample_field", "prophecy_debt", "commit_token", "logit_mean", "delta",
+    "delta_batch", "notorch",
+};
+
+// ── buffers ─────────────────────────────────────────────────────────────────
+
+typedef struct {
+    int n;
+    float* master;        // reference logits
+    float* row;           // working row (BENCH_BATCH_ROWS rows for the batch)
+    uint16_t* master_h;   // bf16 / fp16 masters
+    uint16_t* master_f;
+    uint16_t* row_h;
+    float* topk;          // BENCH_TOPK largest logits of master
+    float mean;
+    float* A;             // delta: n × rank
+    float* B;             // delta: rank × in
+    float* x;             // delta: BENCH_BATCH_ROWS × in
+} BenchBuf;
+
+static unsigned long long g_rng = 0x9e3779b97f4a7c15ULL;
+
+static float bench_randn(void) {
+    // xorshift64* + Box-Muller: logit-shaped values, deterministic per run
+    float u[2];
+    for (int k = 0; k < 2; k++) {
+        g_rng ^= g_rng >> 12; g_rng ^= g_rng << 25; g_rng ^= g_rng >> 27;
+        u[k] = ((g_rng * 0x2545f4914f6cdd1dULL) >> 40) * (1.0f / 16777216.0f);
+    }
+    return sqrtf(-2.0f * logf(u[0] + 1e-7f)) * cosf(6.2831853f * u[1]);
+}
+
+static int by_value_desc(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x < y) - (x > y);
+}
+
+static void* bench_alloc(size_t bytes) {
+    void* p = malloc(bytes);
+    if (!p) { fprintf(stderr, "bench_aml: out of memory\n"); exit(1); }
+    return p;
+}
+
+static void buf_init(BenchBuf* b, int n) {
+    b->n = n;
+    b->master = bench_alloc((size_t)n * sizeof(float));
+    b->row = bench_alloc((size_t)n * BENCH_BATCH_ROWS * sizeof(float));
+    b->master_h = bench_alloc((size_t)n * sizeof(uint16_t));
+    b->master_f = bench_alloc((size_t)n * sizeof(uint16_t));
+    b->row_h = bench_alloc((size_t)n * sizeof(uint16_t));
+    b->topk = bench_alloc(BENCH_TOPK * sizeof(float));
+    b->A = bench_alloc((size_t)n * BENCH_DELTA_RANK * sizeof(float));
+    b->B = bench_alloc((size_t)BENCH_DELTA_RANK * BENCH_DELTA_IN * sizeof(float));
+    b->x = bench_alloc(BENCH_BATCH_ROWS * BENCH_DELTA_IN * sizeof(float));
+
+    for (int i = 0; i < n; i++) {
+        b->master[i] = 3.0f * bench_randn();
+        b->master_h[i] = am_float_to_bf16(b->master[i]);
+        b->master_f[i] = am_float_to_fp16(b->master[i]);
+    }
+    b->master[n / 3] = 14.0f;       // a confident top-1
+    b->master_h[n / 3] = am_float_to_bf16(14.0f);
+    b->master_f[n / 3] = am_float_to_fp16(14.0f);
+    b->mean = am_logit_mean(b->master, n);
+
+    memcpy(b->row, b->master, (size_t)n * sizeof(float));
+    qsort(b->row, n, sizeof(float), by_value_desc);
+    memcpy(b->topk, b->row, BENCH_TOPK * sizeof(float));
+
+    for (size_t i = 0; i < (size_t)n * BENCH_DELTA_RANK; i++) b->A[i] = 0.01f * bench_randn();
+    for (int i = 0; i < BENCH_DELTA_RANK * BENCH_DELTA_IN; i++) b->B[i] = 0.01f * bench_randn();
+    for (int i = 0; i < BENCH_BATCH_ROWS * BENCH_DELTA_IN; i++) b->x[i] = bench_randn();
+}
+
+static void buf_free(BenchBuf* b) {
+    free(b->master); free(b->row); free(b->master_h); free(b->master_f);
+    free(b->row_h); free(b->topk); free(b->A); free(b->B); free(b->x);
+}
+
+// ── one benchmark ───────────────────────────────────────────────────────────
+
+static int g_reps = 0;    // 0: scale with n
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int cmp_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Restore the inputs a benchmark mutates.
+static void bench_prepare(BenchBuf* b, int which) {
+    size_t n = (size_t)b->n;
+    switch (which) {
+    case B_FIELD_BF16: memcpy(b->row_h, b->master_h, n * sizeof(uint16_t)); break;
+    case B_FIELD_FP16: memcpy(b->row_h, b->master_f, n * sizeof(uint16_t)); break;
+    case B_FIELD_BATCH:
+    case B_DELTA_BATCH:
+        for (int r = 0; r < BENCH_BATCH_ROWS; r++)
+            memcpy(b->row + r * n, b->master, n * sizeof(float));
+        break;
+    case B_CANDIDATES: memcpy(b->row, b->topk, BENCH_TOPK * sizeof(float)); break;
+    case B_COMMIT:     // commit prices the row the last field pass left
+        memcpy(b->row, b->master, n * sizeof(float));
+        am_apply_field_to_logits(b->row, b->n);
+        break;
+    case B_DEBT: case B_MEAN: break;
+    default:           memcpy(b->row, b->master, n * sizeof(float)); break;
+    }
+}
+
+static uint64_t g_sample_rng = 42;
+static volatile float g_sink;
+
+static void bench_call(BenchBuf* b, int which) {
+    int n = b->n;
+    int tok;
+    switch (which) {
+    case B_GAMMA:       am_apply_gamma_to_logits(b->row, n); break;
+    case B_DESTINY:     am_apply_destiny_to_logits(b->row, n); break;
+    case B_SUFFERING:   am_apply_suffering_to_logits(b->row, n); break;
+    case B_ATTENTION:   am_apply_attention_to_logits(b->row, n); break;
+    case B_LAWS:        am_apply_laws_to_logits(b->row, n); break;
+    case B_STAGED:      // the unfused host chain
+        am_apply_gamma_to_logits(b->row, n);
+        am_apply_destiny_to_logits(b->row, n);
+        am_apply_suffering_to_logits(b->row, n);
+        am_apply_attention_to_logits(b->row, n);
+        am_apply_laws_to_logits(b->row, n);
+        break;
+    case B_FIELD:       am_apply_field_to_logits(b->row, n); break;
+    case B_FIELD_BF16:  am_apply_field_to_logits_bf16(b->row_h, n); break;
+    case B_FIELD_FP16:  am_apply_field_to_logits_fp16(b->row_h, n); break;
+    case B_FIELD_BATCH:
+        am_apply_field_to_logits_batch(b->row, BENCH_BATCH_ROWS, n, n, NULL);
+        break;
+    case B_CANDIDATES:  am_apply_field_to_candidates(b->row, BENCH_TOPK, b->mean); break;
+    case B_SAMPLE:      g_sink = am_sample_field(b->row, n, &g_sample_rng, &tok); break;
+    case B_DEBT:        g_sink = am_compute_prophecy_debt(b->master, n / 2, n); break;
+    case B_COMMIT:      g_sink = am_commit_token(n / 2); break;
+    case B_MEAN:        g_sink = am_logit_mean(b->master, n); break;
+    case B_DELTA:
+        am_apply_delta(b->row, b->A, b->B, b->x, n, BENCH_DELTA_IN,
+                       BENCH_DELTA_RANK, 0.5f);
+        break;
+    case B_DELTA_BATCH:
+        am_apply_delta_batch(b->row, b->A, b->B, b->x, BENCH_BATCH_ROWS, n,
+                             BENCH_DELTA_IN, BENCH_DELTA_RANK, NULL);
+        break;
+    case B_NOTORCH:     // the delta buffers reused as A [in × rank], B [rank × n]
+        am_notorch_step(b->B, b->A, n, BENCH_DELTA_IN, BENCH_DELTA_RANK,
+                        b->x, b->master, 0.5f);
+        break;
+    }
+}
+
+// Bytes a call has to move (reads + writes) and elements it touches,
+// per token. Fused passes read the row twice and write it once.
+static void bench_traffic(int which, int n, double* bytes, double* elems) {
+    double f = 4.0 * n, h = 2.0 * n;
+    *elems = n;
+    switch (which) {
+    case B_STAGED:      *bytes = 5 * 3 * f; break;
+    case B_FIELD_BF16:
+    case B_FIELD_FP16:  *bytes = 3 * h; break;
+    case B_SAMPLE:      *bytes = 4 * f; break;   // field (3) + sampling read
+    case B_CANDIDATES:  *bytes = 2 * 4.0 * BENCH_TOPK; *elems = BENCH_TOPK; break;
+    case B_DEBT:
+    case B_MEAN:        *bytes = f; break;
+    case B_COMMIT:      *bytes = 4; *elems = 1; break;
+    case B_DELTA:
+        *bytes = 4.0 * ((double)n * BENCH_DELTA_RANK
+                        + BENCH_DELTA_RANK * BENCH_DELTA_IN + BENCH_DELTA_IN) + 2 * f;
+        break;
+    case B_DELTA_BATCH:   // A and B once per batch, per-row traffic per token
+        *bytes = 4.0 * ((double)n * BENCH_DELTA_RANK
+                        + BENCH_DELTA_RANK * BENCH_DELTA_IN) / BENCH_BATCH_ROWS
+               + 4.0 * BENCH_DELTA_IN + 2 * f;
+        break;
+    case B_NOTORCH:       // A and B read and written once, x and dy read
+        *elems = ((double)n + BENCH_DELTA_IN) * BENCH_DELTA_RANK;
+        *bytes = 2 * 4.0 * *elems + 4.0 * BENCH_DELTA_IN + f;
+        break;
+    default:            *bytes = 3 * f; break;
+    }
+}
+
+static int g_first = 1;
+
+static void bench_run(BenchBuf* b, int which, const char* config,
+                      unsigned int stages) {
+    static double ns[BENCH_MAX_REPS], cyc[BENCH_MAX_REPS];
+    int n = b->n;
+    int reps = g_reps > 0 ? g_reps : (int)(50000000LL / n);
+    if (reps < 10) reps = 10;
+    if (reps > BENCH_MAX_REPS) reps = BENCH_MAX_REPS;
+
+    bench_prepare(b, which);
+    bench_call(b, which);   // warm-up
+
+    for (int r = 0; r < reps; r++) {
+        bench_prepare(b, which);
+        double t0 = now_ns();
+        unsigned long long c0 = bench_tsc();
+        bench_call(b, which);
+        unsigned long long c1 = bench_tsc();
+        double t1 = now_ns();
+        ns[r] = t1 - t0;
+        cyc[r] = (double)(c1 - c0);
+    }
+    qsort(ns, reps, sizeof(double), cmp_double);
+    qsort(cyc, reps, sizeof(double), cmp_double);
+
+    double rows = (which == B_FIELD_BATCH || which == B_DELTA_BATCH) ? BENCH_BATCH_ROWS : 1;
+    double per_token = ns[reps / 2] / rows;
+    double bytes, elems;
+    bench_traffic(which, n, &bytes, &elems);
+
+    printf("%s\n    {\"simd\": \"%s\", \"config\": \"%s\", \"stages\": %u, "
+           "\"vocab\": %d, \"bench\": \"%s\", \"reps\": %d, "
+           "\"ns_per_token\": %.1f, \"ns_min\": %.1f, \"gb_per_s\": %.3f, ",
+           g_first ? "" : ",", am_simd_name(), config, stages, n,
+           g_bench_name[which], reps, per_token, ns[0] / rows,
+           per_token > 0 ? bytes / per_token : 0.0);
+    if (BENCH_HAVE_TSC)
+        printf("\"cycles_per_elem\": %.3f}", cyc[reps / 2] / rows / elems);
+    else
+        printf("\"cycles_per_elem\": null}");
+    g_first = 0;
+    fflush(stdout);
+}
+
+// ── main ────────────────────────────────────────────────────────────────────
+
+int main(int argc, char** argv) {
+    int all_simd = 0, threads = 1;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--all-simd")) all_simd = 1;
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--reps") && i + 1 < argc) g_reps = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--all-simd] [--threads N] [--reps N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    am_init();
+    int best = am_simd_level();
+    threads = am_field_threads(threads, 0);
+
+    BenchBuf buf[N_VOCAB];
+    for (int v = 0; v < N_VOCAB; v++) buf_init(&buf[v], g_vocab[v]);
+
+    printf("{\n  \"threads\": %d, \"tsc\": %s, \"batch_rows\": %d, \"topk\": %d,\n"
+           "  \"delta_in\": %d, \"delta_rank\": %d,\n  \"results\": [",
+           threads, BENCH_HAVE_TSC ? "true" : "false", BENCH_BATCH_ROWS,
+           BENCH_TOPK, BENCH_DELTA_IN, BENCH_DELTA_RANK);
+
+    for (int level = all_simd ? AM_SIMD_SCALAR : best; level <= best; level++) {
+        if (am_simd_set(level) != level) continue;
+        for (int c = 0; c < N_CONFIG; c++) {
+            am_init();
+            if (g_config[c].script[0] && am_exec(g_config[c].script) != 0) {
+                fprintf(stderr, "bench_aml: config %s: %s\n",
+                        g_config[c].name, am_get_error());
+                return 1;
+            }
+            if (g_config[c].step) am_step(0.016f);
+            unsigned int stages = am_field_plan()->stages;
+            for (int v = 0; v < N_VOCAB; v++)
+                for (int w = 0; w < B_COUNT; w++)
+                    bench_run(&buf[v], w, g_config[c].name, stages);
+        }
+    }
+    printf("\n  ]\n}\n");
+
+    am_simd_set(best);
+    am_field_threads(1, 0);
+    for (int v = 0; v < N_VOCAB; v++) buf_free(&buf[v]);
+    return 0;
+}
@@ -5,6 +5,10 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#if !defined(AM_THREADS_DISABLED) && !defined(__EMSCRIPTEN__)
+  #define TEST_THREADS
+  #include <pthread.h>
+#endif
 
 static int tests_run = 0;
 static int tests_passed = 0;
@@ -890,6 +894,1477 @@ static void test_logit_laws(void) {
     ASSERT(logits[2] < 20.0f, "entropy floor compresses dominant logit");
 }
 
+// ── TEST 35b: fused pipeline matches the staged chain ─────────────────────
+
+static void fill_logits(float* x, int n, unsigned int seed) {
+    for (int i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        x[i] = ((float)(seed >> 8) / 16777216.0f) * 8.0f - 4.0f;
+    }
+}
+
+static void staged_pipeline(float* x, int n) {
+    am_apply_gamma_to_logits(x, n);
+    am_apply_destiny_to_logits(x, n);
+    am_apply_suffering_to_logits(x, n);
+    am_apply_attention_to_logits(x, n);
+    am_apply_laws_to_logits(x, n);
+}
+
+static float max_abs_diff(const float* a, const float* b, int n) {
+    float d = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float e = fabsf(a[i] - b[i]);
+        if (e > d) d = e;
+    }
+    return d;
+}
+
+static int argmax_of(const float* x, int n) {
+    int best = 0;
+    for (int i = 1; i < n; i++) if (x[i] > x[best]) best = i;
+    return best;
+}
+
+static void test_logit_fused(void) {
+    printf("\n── fused logit pipeline ──\n");
+    enum { N = 4099 };
+    static float fused[N], staged[N];
+    static const char* configs[] = {
+        "PAIN 0.5\nDESTINY 0.5\nPROPHECY 7\nATTEND_FOCUS 0.8",
+        "GAMMA yent 0.9\nESSENCE 0.8\nDESTINY 0.9\nPROPHECY 40",
+        "GAMMA yent 0.8\nGAMMA arianna 0.6\nJANUS yent arianna\nPAIN 0.9\nATTEND_FOCUS 0.1\nATTEND_SPREAD 0.9",
+        "DESTINY 0\nPAIN 0\nATTEND_FOCUS 0.5\nATTEND_SPREAD 0.5",
+    };
+    for (int c = 0; c < 4; c++) {
+        am_init();
+        am_exec(configs[c]);
+        am_step(0.1f);
+        fill_logits(fused, N, 17u + (unsigned)c);
+        fused[N / 3] = 30.0f;  // dominant token: laws must fire
+        memcpy(staged, fused, sizeof(fused));
+        am_apply_field_to_logits(fused, N);
+        staged_pipeline(staged, N);
+        char msg[96];
+        snprintf(msg, sizeof(msg), "fused == staged (config %d)", c);
+        ASSERT(max_abs_diff(fused, staged, N) < 1e-4f, msg);
+        snprintf(msg, sizeof(msg), "fused argmax == staged argmax (config %d)", c);
+        ASSERT_INT(argmax_of(fused, N), argmax_of(staged, N), msg);
+    }
+
+    // tied max: every copy of the top takes the laws reduction
+    am_init();
+    am_exec("LAW ENTROPY_FLOOR 0.5");
+    float a[5] = {0.0f, 20.0f, 1.0f, 20.0f, 0.5f};
+    float b[5];
+    memcpy(b, a, sizeof(a));
+    am_apply_field_to_logits(a, 5);
+    staged_pipeline(b, 5);
+    ASSERT(max_abs_diff(a, b, 5) < 1e-5f, "fused handles tied max like staged");
+}
+
+// ── TEST 35c: SIMD kernels agree with scalar at every level ───────────────
+
+typedef void (*logit_fn)(float*, int);
+
+static void test_logit_simd(void) {
+    printf("\n── SIMD logit kernels (%s) ──\n", am_simd_name());
+    enum { N = 1027 };  // odd: exercises every tail path
+    static float ref[N], got[N];
+    static const logit_fn stages[] = {
+        am_apply_gamma_to_logits, am_apply_destiny_to_logits,
+        am_apply_suffering_to_logits, am_apply_attention_to_logits,
+        am_apply_laws_to_logits, am_apply_field_to_logits,
+    };
+    int best = am_simd_level();
+
+    am_init();
+    am_exec("GAMMA yent 0.9\nESSENCE 0.7\nDESTINY 0.6\nPAIN 0.4\n"
+            "ATTEND_FOCUS 0.9\nATTEND_SPREAD 0.2\nLAW ENTROPY_FLOOR 0.4");
+    am_step(0.1f);
+
+    ASSERT_INT(am_simd_set(AM_SIMD_SCALAR), AM_SIMD_SCALAR, "scalar always available");
+    for (int level = AM_SIMD_NEON; level <= AM_SIMD_AVX512; level++) {
+        int got_level = am_simd_set(level);
+        ASSERT(got_level <= level, "am_simd_set never exceeds the request");
+        if (got_level != level) continue;  // CPU lacks it
+        for (int k = 0; k < 6; k++) {
+            fill_logits(ref, N, 99u + (unsigned)k);
+            ref[N - 2] = 25.0f;  // top in the scalar tail
+            ref[5] = 25.0f;      // tied top in the vector body
+            memcpy(got, ref, sizeof(ref));
+            am_simd_set(AM_SIMD_SCALAR);
+            stages[k](ref, N);
+            am_simd_set(level);
+            stages[k](got, N);
+            char msg[96];
+            snprintf(msg, sizeof(msg), "%s stage %d matches scalar", am_simd_name(), k);
+            ASSERT(max_abs_diff(ref, got, N) < 1e-4f, msg);
+        }
+    }
+    am_simd_set(best);
+    ASSERT_INT(am_simd_level(), best, "restored load-time kernel level");
+}
+
+// ── TEST 35d: batched pipeline ────────────────────────────────────────────
+
+static void test_logit_batch(void) {
+    printf("\n── batched logit pipeline ──\n");
+    enum { ROWS = 3, N = 513, STRIDE = N + 7 };
+    static float tile[ROWS * STRIDE], ref[ROWS][N];
+
+    // shared field: every row matches a single-row call
+    am_init();
+    am_exec("GAMMA yent 0.8\nDESTINY 0.5\nPAIN 0.3\nLAW ENTROPY_FLOOR 0.6");
+    am_step(0.1f);
+    for (int r = 0; r < ROWS; r++) {
+        fill_logits(tile + r * STRIDE, STRIDE, 7u + (unsigned)r);
+        memcpy(ref[r], tile + r * STRIDE, sizeof(ref[r]));
+        am_apply_field_to_logits(ref[r], N);
+    }
+    float pad = tile[STRIDE - 1];
+    am_apply_field_to_logits_batch(tile, ROWS, N, STRIDE, NULL);
+    int same = 1;
+    for (int r = 0; r < ROWS; r++)
+        if (memcmp(ref[r], tile + r * STRIDE, sizeof(ref[r])) != 0) same = 0;
+    ASSERT(same, "batch (shared field) == per-row calls");
+    ASSERT(tile[STRIDE - 1] == pad, "batch leaves row padding untouched");
+
+    // per-row field: each row keeps its own sequence state
+    AM_FieldParams params[ROWS];
+    static const char* fields[ROWS] = {
+        "PAIN 0.9", "DESTINY 0.9\nPROPHECY 30", "ATTEND_FOCUS 0.1\nATTEND_SPREAD 0.8",
+    };
+    for (int r = 0; r < ROWS; r++) {
+        am_init();
+        am_exec(fields[r]);
+        am_step(0.1f);
+        am_field_params_capture(&params[r]);
+        fill_logits(tile + r * STRIDE, STRIDE, 31u + (unsigned)r);
+        memcpy(ref[r], tile + r * STRIDE, sizeof(ref[r]));
+        am_apply_field_to_logits(ref[r], N);
+    }
+    am_init();  // global field differs from every row
+    am_apply_field_to_logits_batch(tile, ROWS, N, STRIDE, params);
+    same = 1;
+    for (int r = 0; r < ROWS; r++)
+        if (memcmp(ref[r], tile + r * STRIDE, sizeof(ref[r])) != 0) same = 0;
+    ASSERT(same, "batch (per-row params) == per-row calls under each field");
+}
+
+// ── TEST 35e: threaded pipeline matches serial ────────────────────────────
+
+static void test_logit_threads(void) {
+    printf("\n── threaded logit pipeline ──\n");
+    enum { N = 50021 };  // odd length: last shard is ragged
+    static float a[N], b[N];
+
+    am_init();
+    am_exec("GAMMA yent 0.8\nDESTINY 0.5\nPAIN 0.3\nLAW ENTROPY_FLOOR 0.6\n"
+            "LAW RESONANCE_CEILING 0.4");
+    am_step(0.1f);
+    fill_logits(a, N, 11u);
+    a[N - 1] = 9.0f;     // top in the last shard
+    a[N / 3] = 8.5f;     // runner-up in another
+    memcpy(b, a, sizeof(a));
+
+    am_apply_field_to_logits(a, N);
+    int nt = am_field_threads(4, 4096);
+    ASSERT(nt >= 1 && nt <= 4, "am_field_threads reports pool size");
+    am_apply_field_to_logits(b, N);
+    ASSERT(max_abs_diff(a, b, N) < 1e-4f, "sharded pipeline matches serial");
+    ASSERT_INT(argmax_of(b, N), argmax_of(a, N), "sharded argmax matches serial");
+
+    // below the cutoff the row stays serial: bit-identical
+    memcpy(b, a, sizeof(a));
+    am_field_threads(4, N + 1);
+    am_apply_field_to_logits(a, N);
+    am_apply_field_to_logits(b, N);
+    ASSERT(memcmp(a, b, sizeof(a)) == 0, "rows under cutoff run serial");
+
+    ASSERT_INT(am_field_threads(0, 0), 1, "am_field_threads(0) stops the pool");
+}
+
+// ── TEST 35f: bf16 / fp16 pipeline ────────────────────────────────────────
+
+typedef float    (*half_to_f)(uint16_t);
+typedef uint16_t (*f_to_half)(float);
+
+static void test_logit_half(void) {
+    printf("\n── half-precision logit pipeline ──\n");
+    enum { N = 1029 };
+    static float ref[N];
+    static uint16_t h[N];
+
+    ASSERT_INT(am_float_to_bf16(1.0f), 0x3F80, "bf16(1.0)");
+    ASSERT_INT(am_float_to_bf16(1.00390625f), 0x3F80, "bf16 ties round to even");
+    ASSERT_INT(am_float_to_bf16(-INFINITY), 0xFF80, "bf16(-inf)");
+    ASSERT_INT(am_float_to_fp16(1.0f), 0x3C00, "fp16(1.0)");
+    ASSERT_INT(am_float_to_fp16(65520.0f), 0x7C00, "fp16 overflow rounds to inf");
+    ASSERT_INT(am_float_to_fp16(5.9604645e-8f), 0x0001, "fp16 smallest subnormal");
+    ASSERT_INT(am_float_to_fp16(-INFINITY), 0xFC00, "fp16(-inf)");
+    ASSERT_FLOAT(am_fp16_to_float(0x3555), 0.333251953f, 1e-9f, "fp16 decode");
+    ASSERT_FLOAT(am_fp16_to_float(0x0001), 5.9604645e-8f, 1e-15f, "fp16 subnormal decode");
+
+    static const half_to_f dec[2] = { am_bf16_to_float, am_fp16_to_float };
+    static const f_to_half enc[2] = { am_float_to_bf16, am_float_to_fp16 };
+    static void (*const apply[2])(uint16_t*, int) = {
+        am_apply_field_to_logits_bf16, am_apply_field_to_logits_fp16,
+    };
+    static const char* fmt_name[2] = { "bf16", "fp16" };
+    static const float ulp[2] = { 1.0f / 128.0f, 1.0f / 1024.0f };
+    int best = am_simd_level();
+
+    am_init();
+    am_exec("GAMMA yent 0.9\nDESTINY 0.6\nPAIN 0.4\nLAW ENTROPY_FLOOR 0.4\n"
+            "LAW RESONANCE_CEILING 0.5");
+    am_step(0.1f);
+    for (int f = 0; f < 2; f++) {
+        for (int level = AM_SIMD_SCALAR; level <= AM_SIMD_AVX512; level++) {
+            if (am_simd_set(level) != level) continue;
+            fill_logits(ref, N, 5u);
+            ref[N - 1] = 9.0f;
+            for (int i = 0; i < N; i++) {
+                h[i] = enc[f](ref[i]);
+                ref[i] = dec[f](h[i]);   // reference sees the rounded input
+            }
+            am_apply_field_to_logits(ref, N);
+            apply[f](h, N);
+            float worst = 0.0f;
+            int amax = 0;
+            for (int i = 0; i < N; i++) {
+                float v = dec[f](h[i]);
+                float e = fabsf(v - ref[i]) / (fabsf(ref[i]) + 1.0f);
+                if (e > worst) worst = e;
+                if (v > dec[f](h[amax])) amax = i;
+            }
+            char msg[96];
+            snprintf(msg, sizeof(msg), "%s/%s within one ulp of fp32", fmt_name[f], am_simd_name());
+            ASSERT(worst <= ulp[f], msg);
+            snprintf(msg, sizeof(msg), "%s/%s keeps the argmax", fmt_name[f], am_simd_name());
+            ASSERT_INT(amax, argmax_of(ref, N), msg);
+        }
+    }
+    am_simd_set(best);
+
+    // debt reads the same max the float path would see
+    float lf[4] = { 1.0f, 3.0f, 2.0f, -1.0f };
+    uint16_t lb[4], lh[4];
+    for (int i = 0; i < 4; i++) { lb[i] = am_float_to_bf16(lf[i]); lh[i] = am_float_to_fp16(lf[i]); }
+    ASSERT_FLOAT(am_compute_prophecy_debt_bf16(lb, 3, 4), am_compute_prophecy_debt(lf, 3, 4),
+                 1e-6f, "bf16 prophecy debt matches fp32");
+    ASSERT_FLOAT(am_compute_prophecy_debt_fp16(lh, 0, 4), am_compute_prophecy_debt(lf, 0, 4),
+                 1e-6f, "fp16 prophecy debt matches fp32");
+    ASSERT_FLOAT(am_compute_prophecy_debt_fp16(lh, 1, 4), 0.0f, 1e-9f, "no debt for the top token");
+}
+
+// ── TEST 35g: sparse candidates match the dense pipeline ──────────────────
+
+static const float* g_rank_src;
+static int by_logit_desc(const void* a, const void* b) {
+    float x = g_rank_src[*(const int*)a], y = g_rank_src[*(const int*)b];
+    return (x < y) - (x > y);
+}
+
+static void test_logit_candidates(void) {
+    printf("\n── sparse candidate mode ──\n");
+    enum { N = 32003, K = 64 };
+    static float dense[N];
+    static int idx[N];
+    float vals[K];
+
+    am_init();
+    am_exec("GAMMA yent 0.8\nDESTINY 0.5\nPAIN 0.3\nATTEND_FOCUS 0.9\n"
+            "LAW ENTROPY_FLOOR 0.6\nLAW RESONANCE_CEILING 0.4");
+    am_step(0.1f);
+    fill_logits(dense, N, 23u);
+    dense[777] = 6.0f;
+    dense[778] = 5.9995f;   // inside the resonance band
+
+    for (int i = 0; i < N; i++) idx[i] = i;
+    g_rank_src = dense;
+    qsort(idx, N, sizeof(int), by_logit_desc);
+    for (int j = 0; j < K; j++) vals[j] = dense[idx[j]];
+
+    float mean = am_logit_mean(dense, N);
+    am_apply_field_to_candidates(vals, K, mean);
+    am_apply_field_to_logits(dense, N);
+
+    int same = 1, ordered = 1;
+    for (int j = 0; j < K; j++) {
+        if (vals[j] != dense[idx[j]]) same = 0;
+        if (j > 0 && vals[j] > vals[j - 1]) ordered = 0;
+    }
+    ASSERT(same, "candidate values == dense values at their indices");
+    ASSERT(ordered, "candidate ranking preserved");
+    ASSERT_INT(argmax_of(dense, N), idx[0], "dense argmax is the top candidate");
+    ASSERT_FLOAT(am_logit_mean(NULL, 4), 0.0f, 1e-9f, "am_logit_mean(NULL) is 0");
+}
+
+// ── TEST 35h: per-step field plan ─────────────────────────────────────────
+
+static void test_field_plan(void) {
+    printf("\n── field plan ──\n");
+    enum { N = 257 };
+    float a[N], b[N];
+
+    am_init();
+    const AM_FieldPlan* plan = am_field_plan();
+    ASSERT_INT((int)plan->stages, AM_PLAN_FLOOR | AM_PLAN_CEILING,
+               "default plan: only the laws (attention k == 1 dropped)");
+
+    am_exec("PAIN 0.5\nGAMMA yent 0.8");
+    ASSERT(plan->stages & AM_PLAN_SUFFERING, "am_exec rebuilds the plan");
+    ASSERT(plan->stages & AM_PLAN_GAMMA, "gamma stage enabled");
+    ASSERT_FLOAT(plan->pain_k, 0.75f, 1e-6f, "pain scale precomputed");
+    ASSERT_FLOAT(plan->gamma_blend, am_gamma_get_blend(), 1e-6f, "gamma blend cached");
+
+    // a host writing state directly must rebuild
+    AM_State* st = am_get_state();
+    st->pain = 0.0f;
+    ASSERT(plan->stages & AM_PLAN_SUFFERING, "direct state writes do not touch the plan");
+    am_field_plan_build();
+    ASSERT(!(plan->stages & AM_PLAN_SUFFERING), "am_field_plan_build picks them up");
+
+    // empty plan: the pipeline is a no-op
+    am_gamma_unload("yent");
+    am_exec("LAW ENTROPY_FLOOR 0\nLAW RESONANCE_CEILING 1");
+    ASSERT_INT((int)plan->stages, 0, "everything off: empty plan");
+    fill_logits(a, N, 3u);
+    memcpy(b, a, sizeof(a));
+    am_apply_field_to_logits(a, N);
+    ASSERT(memcmp(a, b, sizeof(a)) == 0, "empty plan leaves logits untouched");
+}
+
+// ── TEST 35i: fused sampler ───────────────────────────────────────────────
+
+static void test_sample_field(void) {
+    printf("\n── fused sampler ──\n");
+    enum { N = 1031, V = 6, DRAWS = 20000 };
+    static float a[N], b[N];
+    int best = am_simd_level();
+
+    am_init();
+    am_exec("GAMMA yent 0.8\nDESTINY 0.5\nPAIN 0.3\nLAW ENTROPY_FLOOR 0.6");
+    am_step(0.1f);
+
+    fill_logits(a, N, 41u);
+    a[600] = -1e4f;       // masked token
+    memcpy(b, a, sizeof(a));
+    uint64_t rng = 12345, rng2 = 12345;
+    int tok = -2, tok2 = -2;
+    float debt = am_sample_field(a, N, &rng, &tok);
+    am_apply_field_to_logits(b, N);
+    ASSERT(tok >= 0 && tok < N && tok != 600, "sampled a live token");
+    ASSERT(memcmp(a, b, sizeof(a)) == 0, "logits left as am_apply_field_to_logits leaves them");
+    ASSERT_FLOAT(debt, am_compute_prophecy_debt(a, tok, N), 1e-6f, "returns the token's prophecy debt");
+    ASSERT(rng != 12345, "rng state advanced");
+    fill_logits(a, N, 41u);
+    a[600] = -1e4f;
+    am_sample_field(a, N, &rng2, &tok2);
+    ASSERT_INT(tok2, tok, "same seed, same token");
+
+    // frequencies follow softmax(field(logits) / effective_temp) on every level
+    static const float base[V] = { 0.0f, 0.5f, 1.0f, 1.2f, -1.0f, 0.8f };
+    float fin[V];
+    memcpy(fin, base, sizeof(fin));
+    am_apply_field_to_logits(fin, V);
+    double p[V], z = 0.0, T = am_get_temperature();
+    for (int i = 0; i < V; i++) z += (p[i] = exp((fin[i] - fin[3]) / T));
+    for (int level = AM_SIMD_SCALAR; level <= AM_SIMD_AVX512; level++) {
+        if (am_simd_set(level) != level) continue;
+        int hits[V] = {0};
+        uint64_t r = 7;
+        for (int d = 0; d < DRAWS; d++) {
+            float x[V];
+            int c;
+            memcpy(x, base, sizeof(x));
+            am_sample_field(x, V, &r, &c);
+            if (c >= 0) hits[c]++;
+        }
+        double worst = 0.0;
+        for (int i = 0; i < V; i++) {
+            double e = fabs((double)hits[i] / DRAWS - p[i] / z);
+            if (e > worst) worst = e;
+        }
+        char msg[96];
+        snprintf(msg, sizeof(msg), "%s sampling matches softmax (err %.4f)", am_simd_name(), worst);
+        ASSERT(worst < 0.015, msg);
+    }
+    am_simd_set(best);
+
+    int c = 7;
+    ASSERT_FLOAT(am_sample_field(NULL, N, &rng, &c), 0.0f, 1e-9f, "NULL logits: no debt");
+    ASSERT_INT(c, -1, "NULL logits: no token");
+}
+
+// ── TEST 35j: token commit prices against the cached field max ────────────
+
+static void test_commit_token(void) {
+    printf("\n── am_commit_token ──\n");
+    enum { N = 4099 };
+    static float x[N];
+    static uint16_t h[N];
+
+    am_init();
+    AM_State* st = am_get_state();
+    ASSERT_FLOAT(am_commit_token(0), 0.0f, 1e-9f, "no field row yet: nothing to price");
+    ASSERT_INT(st->tokens_committed, 0, "nothing committed");
+
+    // resonance ceiling pushes band entries around: max must come from the rewrite
+    am_exec("GAMMA yent 0.8\nDESTINY 0.5\nLAW ENTROPY_FLOOR 0.9\nLAW RESONANCE_CEILING 0.1");
+    am_step(0.1f);
+    fill_logits(x, N, 77u);
+    x[10] = 12.0f;
+    x[11] = 11.9995f;
+    am_apply_field_to_logits(x, N);
+    float want = am_compute_prophecy_debt(x, 500, N);
+    float debt0 = st->debt, tension0 = st->tension;
+    ASSERT_FLOAT(am_commit_token(500), want, 1e-6f, "commit debt == am_compute_prophecy_debt");
+    ASSERT_FLOAT(st->debt, debt0 + want, 1e-5f, "debt accumulates");
+    ASSERT(st->tension > tension0, "off-destiny token builds tension");
+    ASSERT_FLOAT(st->last_debt, want, 1e-6f, "last_debt recorded");
+    ASSERT_FLOAT(am_commit_token(argmax_of(x, N)), 0.0f, 1e-9f, "top token costs nothing");
+    ASSERT_INT(st->tokens_committed, 2, "tokens_committed counts");
+    ASSERT_FLOAT(am_commit_token(N), 0.0f, 1e-9f, "out of range: ignored");
+    ASSERT_INT(st->tokens_committed, 2, "out of range not counted");
+
+    // half rows, and the sharded pass merges per-shard maxima
+    for (int i = 0; i < N; i++) h[i] = am_float_to_bf16(x[i] * 0.5f);
+    am_apply_field_to_logits_bf16(h, N);
+    ASSERT_FLOAT(am_commit_token(9), am_compute_prophecy_debt_bf16(h, 9, N), 1e-6f,
+                 "bf16 row priced like am_compute_prophecy_debt_bf16");
+    am_field_threads(3, 1024);
+    fill_logits(x, N, 78u);
+    am_apply_field_to_logits(x, N);
+    ASSERT_FLOAT(am_commit_token(123), am_compute_prophecy_debt(x, 123, N), 1e-6f,
+                 "sharded row priced correctly");
+    am_field_threads(1, 0);
+
+    // empty plan: the row was never read, commit falls back to one scan
+    am_gamma_unload("yent");
+    am_exec("DESTINY 0\nLAW ENTROPY_FLOOR 0\nLAW RESONANCE_CEILING 1\n"
+            "ATTEND_FOCUS 0.5\nATTEND_SPREAD 0.5");
+    am_step(0.1f);
+    ASSERT_INT((int)am_field_plan()->stages, 0, "plan is empty");
+    fill_logits(x, N, 79u);
+    am_apply_field_to_logits(x, N);
+    ASSERT_FLOAT(am_commit_token(7), am_compute_prophecy_debt(x, 7, N), 1e-6f,
+                 "empty plan: commit scans once");
+
+    am_apply_field_to_logits_batch(x, 1, N, N, NULL);
+    ASSERT_FLOAT(am_commit_token(7), 0.0f, 1e-9f, "after a batch: no single row to price");
+}
+
+// ── TEST 35k: rank-specialised delta kernels ─────────────────────────────
+
+static void test_delta_kernels(void) {
+    printf("\n── delta kernels ──\n");
+    enum { OUT = 203, IN = 77, RMAX = 130 };
+    static float A[OUT * RMAX], B[RMAX * IN], x[IN], base[OUT];
+    static float out[OUT], out2[OUT], scratch[RMAX];
+    static const int ranks[] = { 1, 3, 4, 8, 12, 16, 24, 32, 48, 64, RMAX };
+    fill_logits(A, OUT * RMAX, 101u);
+    fill_logits(B, RMAX * IN, 102u);
+    fill_logits(x, IN, 103u);
+    fill_logits(base, OUT, 104u);
+
+    int best = am_simd_level();
+    for (int level = AM_SIMD_SCALAR; level <= AM_SIMD_AVX512; level++) {
+        if (am_simd_set(level) != level) continue;
+        int ok = 1, same = 1;
+        for (size_t k = 0; k < sizeof(ranks) / sizeof(ranks[0]); k++) {
+            int R = ranks[k];
+            double t[RMAX];
+            for (int r = 0; r < R; r++) {
+                t[r] = 0.0;
+                for (int j = 0; j < IN; j++) t[r] += (double)B[r * IN + j] * x[j];
+            }
+            memcpy(out, base, sizeof(out));
+            memcpy(out2, base, sizeof(out2));
+            am_apply_delta(out, A, B, x, OUT, IN, R, 0.25f);
+            am_apply_delta_scratch(out2, A, B, x, OUT, IN, R, 0.25f, scratch);
+            for (int i = 0; i < OUT; i++) {
+                double want = 0.0, mag = 0.0;
+                for (int r = 0; r < R; r++) {
+                    want += (double)A[i * R + r] * t[r];
+                    mag += fabs((double)A[i * R + r] * t[r]);
+                }
+                want = base[i] + 0.25 * want;
+                if (fabs(out[i] - want) > 1e-5 * (0.25 * mag + fabs(base[i])) + 1e-6) ok = 0;
+                if (out[i] != out2[i]) same = 0;
+            }
+        }
+        char msg[96];
+        snprintf(msg, sizeof(msg), "%s: delta matches reference at every rank", am_simd_name());
+        ASSERT(ok, msg);
+        snprintf(msg, sizeof(msg), "%s: scratch variant identical", am_simd_name());
+        ASSERT(same, msg);
+    }
+    am_simd_set(best);
+
+    // rank above the stack limit is applied in full, not truncated
+    memset(out, 0, sizeof(out));
+    am_apply_delta(out, A, B, x, OUT, IN, RMAX, 1.0f);
+    memset(out2, 0, sizeof(out2));
+    am_apply_delta(out2, A, B, x, OUT, IN, AM_DELTA_MAX_STACK_RANK, 1.0f);
+    int differs = 0;
+    for (int i = 0; i < OUT; i++) if (out[i] != out2[i]) differs = 1;
+    ASSERT(differs, "rank 130 uses all 130 components");
+
+    memcpy(out, base, sizeof(out));
+    am_apply_delta(out, A, B, x, OUT, IN, 0, 1.0f);
+    ASSERT(memcmp(out, base, sizeof(out)) == 0, "rank 0 is a no-op");
+}
+
+// ── TEST 35l: batched delta voice ─────────────────────────────────────────
+
+static void test_delta_batch(void) {
+    printf("\n── am_apply_delta_batch ──\n");
+    enum { OUT = 203, IN = 77, RMAX = 130, BATCH = 40 };   // 40 × 130 spills the stack tile
+    static float A[OUT * RMAX], B[RMAX * IN], X[BATCH * IN];
+    static float out[BATCH * OUT], ref[BATCH * OUT], alphas[BATCH];
+    static const int ranks[] = { 3, 8, 16, 64, RMAX };
+    fill_logits(A, OUT * RMAX, 201u);
+    fill_logits(B, RMAX * IN, 202u);
+    fill_logits(X, BATCH * IN, 203u);
+    for (int b = 0; b < BATCH; b++) alphas[b] = (b % 7 == 3) ? 0.0f : 0.1f * (float)(b + 1);
+
+    int best = am_simd_level();
+    for (int level = AM_SIMD_SCALAR; level <= AM_SIMD_AVX512; level++) {
+        if (am_simd_set(level) != level) continue;
+        int same = 1;
+        for (size_t k = 0; k < sizeof(ranks) / sizeof(ranks[0]); k++) {
+            int R = ranks[k];
+            fill_logits(out, BATCH * OUT, 204u);
+            memcpy(ref, out, sizeof(ref));
+            am_apply_delta_batch(out, A, B, X, BATCH, OUT, IN, R, alphas);
+            for (int b = 0; b < BATCH; b++)
+                am_apply_delta(ref + b * OUT, A, B, X + b * IN, OUT, IN, R, alphas[b]);
+            if (memcmp(out, ref, sizeof(out)) != 0) same = 0;
+        }
+        char msg[96];
+        snprintf(msg, sizeof(msg), "%s: batch == per-sequence am_apply_delta", am_simd_name());
+        ASSERT(same, msg);
+    }
+    am_simd_set(best);
+
+    fill_logits(out, BATCH * OUT, 205u);
+    memcpy(ref, out, sizeof(ref));
+    am_apply_delta_batch(out, A, B, X, 3, OUT, IN, 16, NULL);
+    for (int b = 0; b < 3; b++)
+        am_apply_delta(ref + b * OUT, A, B, X + b * IN, OUT, IN, 16, 1.0f);
+    ASSERT(memcmp(out, ref, sizeof(out)) == 0, "NULL alphas = 1, rows past batch untouched");
+}
+
+// ── TEST 35m: stacked adapters over gamma slots ──────────────────────────
+
+static void test_delta_stack(void) {
+    printf("\n── am_apply_delta_stack ──\n");
+    enum { OUT = 203, IN = 77 };
+    static float A0[OUT * 8], B0[8 * IN], A2[OUT * 5], B2[5 * IN], x[IN];
+    static float out[OUT], ref[OUT];
+    fill_logits(A0, OUT * 8, 301u);
+    fill_logits(B0, 8 * IN, 302u);
+    fill_logits(A2, OUT * 5, 303u);
+    fill_logits(B2, 5 * IN, 304u);
+    fill_logits(x, IN, 305u);
+
+    const float* As[3] = { A0, NULL, A2 };
+    const float* Bs[3] = { B0, NULL, B2 };
+    int ranks[3] = { 8, 0, 5 };
+    AM_DeltaStack st;
+    ASSERT_INT(am_delta_stack_init(&st, 3, As, Bs, ranks, OUT, IN), 0, "stack packs 3 slots");
+    ASSERT_INT(st.rank, 13, "stacked rank = 8 + 0 + 5");
+
+    float alphas[3] = { 0.3f, 0.9f, -0.6f };
+    fill_logits(out, OUT, 306u);
+    memcpy(ref, out, sizeof(ref));
+    am_apply_delta_stack(out, &st, x, alphas);
+    am_apply_delta(ref, A0, B0, x, OUT, IN, 8, 0.3f);
+    am_apply_delta(ref, A2, B2, x, OUT, IN, 5, -0.6f);
+    float err = 0.0f, mag = 0.0f;
+    for (int i = 0; i < OUT; i++) {
+        err = fmaxf(err, fabsf(out[i] - ref[i]));
+        mag = fmaxf(mag, fabsf(ref[i]));
+    }
+    ASSERT(err <= 1e-5f * mag, "one fused pass == per-adapter am_apply_delta");
+
+    // alphas from the field: janus dual over slots 0 and 2
+    am_init();
+    am_gamma_load("yent", 0.8f);
+    am_gamma_load("mid", 0.5f);
+    am_gamma_load("arianna", 0.6f);
+    am_janus_set("yent", "arianna");
+    float w[AM_MAX_GAMMA];
+    am_gamma_slot_weights(w);
+    ASSERT_FLOAT(w[0] + w[1] + w[2], am_gamma_get_blend(), 1e-6f, "slot weights sum to the blend");
+    ASSERT_FLOAT(w[1], 0.0f, 1e-9f, "slot outside the janus pair gets nothing");
+    fill_logits(out, OUT, 307u);
+    memcpy(ref, out, sizeof(ref));
+    am_apply_delta_stack(out, &st, x, NULL);
+    am_apply_delta_stack(ref, &st, x, w);
+    ASSERT(memcmp(out, ref, sizeof(out)) == 0, "NULL alphas = the plan's slot weights");
+
+    am_gamma_unload("yent");
+    am_gamma_unload("mid");
+    am_gamma_unload("arianna");
+    memcpy(ref, out, sizeof(ref));
+    am_apply_delta_stack(out, &st, x, NULL);
+    ASSERT(memcmp(out, ref, sizeof(out)) == 0, "no gamma loaded: no delta");
+
+    am_delta_stack_free(&st);
+    ASSERT(st.A == NULL && st.rank == 0, "free clears the stack");
+    int bad[1] = { 4 };
+    ASSERT_INT(am_delta_stack_init(&st, 1, As + 1, Bs + 1, bad, OUT, IN), -1,
+               "missing matrices rejected");
+}
+
+// ── TEST 35n: quantized adapters ──────────────────────────────────────────
+
+static void test_qmatrix(void) {
+    printf("\n── quantized adapters ──\n");
+    enum { OUT = 203, IN = 77, ROWS = 5, COLS = 96 };
+    static float src[OUT * IN], deq[OUT * IN], ref[OUT * IN];
+    static float Af[OUT * 8], Bf[8 * IN], x[IN], out[OUT], out2[OUT];
+    AM_QMatrix A, B, m;
+
+    // round trip: every value within half a step of its group scale
+    int ok = 1;
+    for (int type = AM_Q_INT8; type <= AM_Q_INT4; type++) {
+        static const int groups[] = { 0, 1, 3, 4, 12, 32 };
+        for (size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); g++) {
+            int rows = 7, cols = 96;
+            fill_logits(src, rows * cols, 401u + (unsigned)g);
+            if (am_qmatrix_init(&m, rows, cols, type, groups[g], 0) != 0) { ok = 0; continue; }
+            am_qmatrix_quantize(&m, src, NULL);
+            am_qmatrix_dequantize(&m, deq);
+            for (int i = 0; i < rows * cols; i++)
+                if (fabsf(deq[i] - src[i]) > 0.5f * m.scale[i / m.group] * 1.001f) ok = 0;
+            am_qmatrix_free(&m);
+        }
+    }
+    ASSERT(ok, "int8 / int4 round trip within half a step");
+    ASSERT_INT(am_qmatrix_init(&m, 4, 10, AM_Q_INT8, 4, 0), -1, "group must divide cols");
+
+    // SIMD dequant == scalar for every group shape
+    int best = am_simd_level();
+    int same = 1;
+    for (int type = AM_Q_INT8; type <= AM_Q_INT4; type++) {
+        static const int groups[] = { 1, 2, 3, 4, 8, 12, 16, 24, 32, 48, 96 };
+        for (size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); g++) {
+            fill_logits(src, ROWS * COLS, 411u + (unsigned)g);
+            am_qmatrix_init(&m, ROWS, COLS, type, groups[g], 0);
+            am_qmatrix_quantize(&m, src, NULL);
+            am_simd_set(AM_SIMD_SCALAR);
+            am_qmatrix_dequantize(&m, ref);
+            for (int level = AM_SIMD_NEON; level <= AM_SIMD_AVX512; level++) {
+                if (am_simd_set(level) != level) continue;
+                am_qmatrix_dequantize(&m, deq);
+                if (memcmp(deq, ref, ROWS * COLS * sizeof(float)) != 0) same = 0;
+            }
+            am_qmatrix_free(&m);
+        }
+    }
+    am_simd_set(best);
+    ASSERT(same, "SIMD dequant matches scalar for every group");
+
+    // am_apply_delta_q == am_apply_delta on the dequantized matrices
+    static const struct { int type, rank, ga, gb; } cfg[] = {
+        { AM_Q_INT8, 8, 0, 11 }, { AM_Q_INT4, 8, 4, 0 }, { AM_Q_INT4, 5, 0, 7 },
+    };
+    fill_logits(x, IN, 421u);
+    for (size_t c = 0; c < sizeof(cfg) / sizeof(cfg[0]); c++) {
+        int R = cfg[c].rank;
+        fill_logits(Af, OUT * R, 422u);
+        fill_logits(Bf, R * IN, 423u);
+        am_qmatrix_init(&A, OUT, R, cfg[c].type, cfg[c].ga, 0);
+        am_qmatrix_init(&B, R, IN, cfg[c].type, cfg[c].gb, 0);
+        am_qmatrix_quantize(&A, Af, NULL);
+        am_qmatrix_quantize(&B, Bf, NULL);
+        am_qmatrix_dequantize(&A, Af);
+        am_qmatrix_dequantize(&B, Bf);
+        same = 1;
+        for (int level = AM_SIMD_SCALAR; level <= AM_SIMD_AVX512; level++) {
+            if (am_simd_set(level) != level) continue;
+            fill_logits(out, OUT, 424u);
+            memcpy(out2, out, sizeof(out));
+            am_apply_delta_q(out, &A, &B, x, 0.7f);
+            am_apply_delta(out2, Af, Bf, x, OUT, IN, R, 0.7f);
+            if (memcmp(out, out2, sizeof(out)) != 0) same = 0;
+        }
+        am_simd_set(best);
+        char msg[96];
+        snprintf(msg, sizeof(msg), "%s rank %d: delta_q == delta on dequantized",
+                 cfg[c].type == AM_Q_INT8 ? "int8" : "int4", R);
+        ASSERT(same, msg);
+        am_qmatrix_free(&A);
+        am_qmatrix_free(&B);
+    }
+
+    // NOTORCH through an fp32 shadow
+    am_init();
+    am_exec("NOTORCH_LR 0.1");
+    float xs[4] = { 1.0f, 0.5f, -0.5f, 0.25f }, dys[6] = { 0.3f, -0.1f, 0.2f, 0.0f, 0.5f, -0.4f };
+    am_qmatrix_init(&A, 4, 2, AM_Q_INT8, 0, 1);
+    am_qmatrix_init(&B, 2, 6, AM_Q_INT4, 0, 1);
+    for (int i = 0; i < 5; i++) am_notorch_step_q(&A, &B, xs, dys, 1.0f);
+    am_qmatrix_dequantize(&B, deq);
+    float bnorm = 0.0f;
+    ok = 1;
+    for (int i = 0; i < 12; i++) {
+        bnorm += B.shadow[i] * B.shadow[i];
+        if (fabsf(deq[i] - B.shadow[i]) > 0.5f * B.scale[i / 6] * 1.001f) ok = 0;
+    }
+    ASSERT(bnorm > 0.0f, "shadow trained");
+    ASSERT(ok, "quantized B tracks its shadow");
+    am_qmatrix_free(&A);
+    am_qmatrix_free(&B);
+
+    // stochastic rounding keeps 0.3 unbiased where nearest gives 2/7
+    enum { N = 4096 };
+    static float col[N * 2];
+    for (int i = 0; i < N; i++) { col[2 * i] = 1.0f; col[2 * i + 1] = 0.3f; }
+    am_qmatrix_init(&A, N, 2, AM_Q_INT4, 0, 0);
+    am_qmatrix_quantize(&A, col, NULL);
+    am_qmatrix_dequantize(&A, src);
+    ASSERT_FLOAT(src[1], 2.0f / 7.0f, 1e-6f, "nearest: 0.3 lands on 2/7");
+    uint64_t rng = 7;
+    am_qmatrix_quantize(&A, col, &rng);
+    am_qmatrix_dequantize(&A, src);
+    double s1 = 0.0;
+    for (int i = 0; i < N; i++) s1 += src[2 * i + 1];
+    ASSERT_FLOAT((float)(s1 / N), 0.3f, 0.005f, "stochastic rounding is unbiased");
+
+    // no shadow: the step runs on widened values and lands back in int4
+    am_qmatrix_init(&B, 2, 1, AM_Q_INT4, 0, 0);
+    float ones[N], dy1[1] = { 1.0f };
+    for (int i = 0; i < N; i++) ones[i] = 1.0f;
+    am_notorch_step_q(&A, &B, ones, dy1, 1.0f);
+    am_qmatrix_dequantize(&B, src);
+    ASSERT(B.scale[0] > 0.0f && src[0] != 0.0f, "shadowless B trained");
+
+    // rounding state lives in the matrix: the same run after am_init repeats
+    AM_QMatrix A2, B2;
+    am_init();
+    am_exec("NOTORCH_LR 0.1");
+    am_qmatrix_init(&A2, 4, 2, AM_Q_INT4, 0, 0);
+    am_qmatrix_init(&B2, 2, 6, AM_Q_INT4, 0, 0);
+    for (int i = 0; i < 5; i++) am_notorch_step_q(&A2, &B2, xs, dys, 1.0f);
+    uint8_t q1[6];
+    memcpy(q1, B2.q, sizeof(q1));
+    am_qmatrix_free(&A2);
+    am_qmatrix_free(&B2);
+    am_init();
+    am_exec("NOTORCH_LR 0.1");
+    am_qmatrix_init(&A2, 4, 2, AM_Q_INT4, 0, 0);
+    am_qmatrix_init(&B2, 2, 6, AM_Q_INT4, 0, 0);
+    for (int i = 0; i < 5; i++) am_notorch_step_q(&A2, &B2, xs, dys, 1.0f);
+    ASSERT(memcmp(q1, B2.q, sizeof(q1)) == 0, "stochastic rounding repeats after am_init");
+    am_qmatrix_free(&A2);
+    am_qmatrix_free(&B2);
+    am_qmatrix_free(&A);
+    am_qmatrix_free(&B);
+}
+
+// ── TEST 35o: fused NOTORCH step ───────────────────────────────────────────
+
+static void test_notorch_fused(void) {
+    printf("\n── fused NOTORCH step ──\n");
+    enum { IN = 37, OUT = 53, R = 6 };
+    static float A[IN * R], B[R * OUT], x[IN], dy[OUT];
+    am_init();
+    am_exec("NOTORCH_LR 0.1\nNOTORCH_DECAY 0.999");
+
+    // signal 0: a pure decay step, priced from the RMS of A (5 → 0.997)
+    for (int i = 0; i < IN * R; i++) A[i] = (i & 1) ? 5.0f : -5.0f;
+    for (int i = 0; i < R * OUT; i++) B[i] = 2.0f;
+    for (int i = 0; i < IN; i++) x[i] = 1.0f;
+    for (int i = 0; i < OUT; i++) dy[i] = 1.0f;
+    am_notorch_step(A, B, OUT, IN, R, x, dy, 0.0f);
+    ASSERT_FLOAT(A[1], 5.0f * 0.997f, 1e-5f, "A decayed by the adaptive factor");
+    ASSERT_FLOAT(B[7], 2.0f * 0.997f, 1e-5f, "B decayed by the same factor");
+
+    // the plain step keeps no state: A rewritten in place is measured afresh
+    for (int i = 0; i < IN * R; i++) A[i] = 0.5f;
+    am_notorch_step(A, B, OUT, IN, R, x, dy, 0.0f);
+    ASSERT_FLOAT(A[1], 0.5f * 0.9988f, 1e-6f, "plain step measures A on every call");
+
+    // the fused step reuses the RMS the caller carries
+    float rms = -1.0f;
+    for (int i = 0; i < IN * R; i++) A[i] = (i & 1) ? 5.0f : -5.0f;
+    am_notorch_step_fused(A, B, OUT, IN, R, x, dy, 0.0f, &rms, NULL);
+    am_notorch_step_fused(A, B, OUT, IN, R, x, dy, 0.0f, &rms, NULL);
+    float d2 = 0.999f - 0.004f * (5.0f * 0.997f / 10.0f);
+    ASSERT_FLOAT(A[1], 5.0f * 0.997f * d2, 1e-5f, "carried RMS drives the next decay");
+
+    // caller-owned RMS tracks A exactly through training steps
+    rms = -1.0f;
+    fill_logits(A, IN * R, 501u);
+    fill_logits(B, R * OUT, 502u);
+    fill_logits(x, IN, 503u);
+    fill_logits(dy, OUT, 504u);
+    for (int s = 0; s < 5; s++)
+        am_notorch_step_fused(A, B, OUT, IN, R, x, dy, (s & 1) ? -0.7f : 1.3f, &rms, NULL);
+    double ss = 0.0;
+    for (int i = 0; i < IN * R; i++) ss += (double)A[i] * A[i];
+    ASSERT_FLOAT(rms, (float)sqrt(ss / (IN * R)), 1e-5f, "carried RMS equals RMS of A");
+
+    // clamp applies in the same pass
+    for (int i = 0; i < IN; i++) x[i] = 1e4f;
+    for (int i = 0; i < OUT; i++) dy[i] = -1e4f;
+    am_notorch_step_fused(A, B, OUT, IN, R, x, dy, 2.0f, &rms, NULL);
+    int inside = 1;
+    for (int i = 0; i < IN * R; i++) if (fabsf(A[i]) > 10.0f) inside = 0;
+    for (int i = 0; i < R * OUT; i++) if (fabsf(B[i]) > 10.0f) inside = 0;
+    ASSERT(inside, "A and B clamped to [-10, 10]");
+
+    // decay off: signal 0 leaves both matrices untouched
+    am_get_state()->notorch_decay = 0.0f;
+    float a0 = A[3], b0 = B[3];
+    am_notorch_step_fused(A, B, OUT, IN, R, x, dy, 0.0f, &rms, NULL);
+    ASSERT(A[3] == a0 && B[3] == b0, "no decay when NOTORCH_DECAY is off");
+}
+
+// ── TEST 35p: lazily decayed adapter ───────────────────────────────────────
+
+static void test_adapter(void) {
+    printf("\n── lazy-decay adapter ──\n");
+    enum { IN = 41, OUT = 67, R = 5, STEPS = 12 };
+    static float An[IN * R], Bn[R * OUT], Ad[OUT * R], Bd[R * IN];
+    static float xs[STEPS][IN], dys[STEPS][OUT], out[OUT], ref[OUT], x[IN];
+    static const float sig[STEPS] = { 1.0f, 0.0f, -0.6f, 2.0f, 0.0f, 0.0f,
+                                      0.3f, -1.5f, 1.0f, 0.0f, 0.8f, -0.2f };
+    AM_Adapter ad;
+
+    fill_logits(An, IN * R, 601u);
+    fill_logits(Bn, R * OUT, 602u);
+    for (int k = 0; k < STEPS; k++) {
+        fill_logits(xs[k], IN, 610u + k);
+        fill_logits(dys[k], OUT, 630u + k);
+        for (int i = k; i < IN; i += 3) xs[k][i] = 0.0f;     // sparse rows
+        for (int j = k; j < OUT; j += 2) dys[k][j] = 0.0f;
+    }
+    for (int i = 0; i < IN; i++)
+        for (int r = 0; r < R; r++) Bd[r * IN + i] = An[i * R + r];
+    for (int r = 0; r < R; r++)
+        for (int j = 0; j < OUT; j++) Ad[j * R + r] = Bn[r * OUT + j];
+
+    // reference: the eager step on NOTORCH-layout matrices
+    am_init();
+    am_exec("NOTORCH_LR 0.2\nNOTORCH_DECAY 0.995");
+    float rms = -1.0f;
+    for (int k = 0; k < STEPS; k++)
+        am_notorch_step_fused(An, Bn, OUT, IN, R, xs[k], dys[k], sig[k], &rms, NULL);
+
+    am_init();
+    am_exec("NOTORCH_LR 0.2\nNOTORCH_DECAY 0.995");
+    ASSERT_INT(am_adapter_init(&ad, OUT, IN, R, 42), 0, "adapter init");
+    am_adapter_load(&ad, Ad, Bd);
+    for (int k = 0; k < STEPS; k++) am_adapter_step(&ad, xs[k], dys[k], sig[k]);
+    ASSERT(ad.scale < 1.0f, "decay folded into the scale");
+
+    float err = 0.0f;
+    for (int i = 0; i < IN; i++)
+        for (int r = 0; r < R; r++)
+            err = fmaxf(err, fabsf(ad.scale * ad.B[r * IN + i] - An[i * R + r]));
+    for (int r = 0; r < R; r++)
+        for (int j = 0; j < OUT; j++)
+            err = fmaxf(err, fabsf(ad.scale * ad.A[j * R + r] - Bn[r * OUT + j]));
+    ASSERT(err < 1e-4f, "lazy adapter == eager NOTORCH");
+
+    // apply consumes the scale: same as am_apply_delta on the true factors
+    am_adapter_renorm(&ad);
+    ASSERT_FLOAT(ad.scale, 1.0f, 0.0f, "renorm resets the scale");
+    fill_logits(x, IN, 660u);
+    memset(out, 0, sizeof(out));
+    memset(ref, 0, sizeof(ref));
+    am_apply_delta(ref, ad.A, ad.B, x, OUT, IN, R, 0.7f);
+    for (int i = 0; i < OUT * R; i++) ad.A[i] *= 2.0f;
+    for (int i = 0; i < R * IN; i++) ad.B[i] *= 2.0f;
+    ad.scale = 0.5f;
+    am_adapter_apply(&ad, out, x, 0.7f);
+    err = 0.0f;
+    for (int j = 0; j < OUT; j++) err = fmaxf(err, fabsf(out[j] - ref[j]));
+    ASSERT(err < 1e-4f, "am_adapter_apply folds scale^2 into alpha");
+
+    // zero signal for long enough renormalizes before the scale underflows
+    am_adapter_load(&ad, Ad, Bd);
+    int low = 0;
+    for (int k = 0; k < 1000; k++) {
+        am_adapter_step(&ad, xs[0], dys[0], 0.0f);
+        if (ad.scale < AM_ADAPTER_MIN_SCALE) low = 1;
+    }
+    ASSERT(!low, "scale renormalized at AM_ADAPTER_MIN_SCALE");
+    am_adapter_free(&ad);
+}
+
+// ── TEST 35q: asynchronous learner ─────────────────────────────────────────
+
+static void test_learner(void) {
+    printf("\n── async NOTORCH learner ──\n");
+    enum { IN = 29, OUT = 45, R = 4, STEPS = 40 };
+    static float xs[STEPS][IN], dys[STEPS][OUT], A0[OUT * R], B0[R * IN];
+    AM_Adapter ad, ref;
+
+    fill_logits(A0, OUT * R, 701u);
+    fill_logits(B0, R * IN, 702u);
+    for (int k = 0; k < STEPS; k++) {
+        fill_logits(xs[k], IN, 710u + k);
+        fill_logits(dys[k], OUT, 760u + k);
+    }
+
+    // reference: the same records stepped synchronously from a fresh state
+    am_init();
+    am_exec("NOTORCH_LR 0.05");
+    am_adapter_init(&ref, OUT, IN, R, 42);
+    am_adapter_load(&ref, A0, B0);
+    for (int k = 0; k < STEPS; k++) am_adapter_step(&ref, xs[k], dys[k], (k % 5) ? 0.5f : -1.0f);
+
+    am_init();
+    am_exec("NOTORCH_LR 0.05");
+    am_adapter_init(&ad, OUT, IN, R, 42);
+    am_adapter_load(&ad, A0, B0);
+    ASSERT_INT(am_learner_push(xs[0], dys[0], 1.0f), -1, "push without a learner is refused");
+    ASSERT_INT(am_learner_start(&ad), 0, "learner started");
+    ASSERT_INT(am_learner_start(&ad), -1, "one learner at a time");
+
+    int pushed = 0;
+    for (int k = 0; k < 8; k++)
+        pushed += am_learner_push(xs[k], dys[k], (k % 5) ? 0.5f : -1.0f) == 0;
+    ASSERT_INT(pushed, 8, "records queued");
+    ASSERT(ad.A[0] == A0[0] && ad.B[3] == B0[3] && ad.scale == 1.0f,
+           "front unchanged between step boundaries");
+
+    // the rest goes through am_step boundaries; wait when the ring is full
+    for (int k = 8; k < STEPS; k++) {
+        while (am_learner_push(xs[k], dys[k], (k % 5) ? 0.5f : -1.0f) != 0)
+            am_step(0.0f);
+        am_step(0.0f);
+    }
+    am_learner_sync();
+    int same = ad.scale == ref.scale;
+    for (int i = 0; i < OUT * R; i++) same &= ad.A[i] == ref.A[i];
+    for (int i = 0; i < R * IN; i++) same &= ad.B[i] == ref.B[i];
+    ASSERT(same, "async adapter == synchronous steps (bit-exact)");
+
+    am_learner_stop();
+    ASSERT_INT(am_learner_push(xs[0], dys[0], 1.0f), -1, "stopped learner refuses pushes");
+    ASSERT_INT(am_learner_start(&ad), 0, "learner restarts after stop");
+    am_learner_stop();
+    am_adapter_free(&ad);
+    am_adapter_free(&ref);
+}
+
+// ── TEST 35r: mini-batch NOTORCH ───────────────────────────────────────────
+
+static void test_notorch_batch(void) {
+    printf("\n── mini-batch NOTORCH ──\n");
+    enum { IN = 33, OUT = 1100, R = 6, K = 5 };
+    static float A[IN * R], B[R * OUT], A2[IN * R], B2[R * OUT];
+    static float X[K * IN], DY[K * OUT];
+    static const float sig[K] = { 1.0f, -0.4f, 0.0f, 2.5f, 0.7f };
+
+    fill_logits(A, IN * R, 801u);
+    fill_logits(B, R * OUT, 802u);
+    fill_logits(X, K * IN, 803u);
+    fill_logits(DY, K * OUT, 804u);
+    for (int i = 0; i < IN; i += 4) X[IN + i] = 0.0f;
+    for (int i = 0; i < IN * R; i++) A[i] *= 0.1f;
+    for (int i = 0; i < R * OUT; i++) B[i] *= 0.1f;
+    memcpy(A2, A, sizeof(A));
+    memcpy(B2, B, sizeof(B));
+
+    // decay off and no clamp: the batch is the sum of k single steps
+    am_init();
+    am_exec("NOTORCH_LR 0.01");
+    am_get_state()->notorch_decay = 0.0f;
+    for (int e = 0; e < K; e++)
+        am_notorch_step(A, B, OUT, IN, R, X + e * IN, DY + e * OUT, sig[e]);
+    am_init();
+    am_exec("NOTORCH_LR 0.01");
+    am_get_state()->notorch_decay = 0.0f;
+    float rms = -1.0f;
+    am_notorch_step_batch(A2, B2, OUT, IN, R, X, DY, sig, K, &rms, NULL);
+    float err = 0.0f;
+    for (int i = 0; i < IN * R; i++) err = fmaxf(err, fabsf(A[i] - A2[i]));
+    for (int i = 0; i < R * OUT; i++) err = fmaxf(err, fabsf(B[i] - B2[i]));
+    ASSERT(err < 1e-5f, "batch == sum of single steps (decay off)");
+    double ss = 0.0;
+    for (int i = 0; i < IN * R; i++) ss += (double)A2[i] * A2[i];
+    ASSERT_FLOAT(rms, (float)sqrt(ss / (IN * R)), 1e-5f, "batch carries the RMS of A");
+
+    // decay applies once per batch, not once per experience
+    static const float zero[K] = { 0 };
+    am_init();
+    am_exec("NOTORCH_DECAY 0.999");
+    for (int i = 0; i < IN * R; i++) A[i] = (i & 1) ? 5.0f : -5.0f;
+    for (int i = 0; i < R * OUT; i++) B[i] = 2.0f;
+    rms = -1.0f;
+    am_notorch_step_batch(A, B, OUT, IN, R, X, DY, zero, K, &rms, NULL);
+    ASSERT_FLOAT(A[1], 5.0f * 0.997f, 1e-5f, "one decay per batch on A");
+    ASSERT_FLOAT(B[OUT + 9], 2.0f * 0.997f, 1e-5f, "one decay per batch on B");
+
+    // clamp once, after the summed update
+    static const float strong[K] = { 2.0f, 2.0f, 2.0f, 2.0f, 2.0f };
+    for (int i = 0; i < K * IN; i++) X[i] = 1e4f;
+    am_notorch_step_batch(A, B, OUT, IN, R, X, DY, strong, K, &rms, NULL);
+    int inside = 1;
+    for (int i = 0; i < IN * R; i++) if (fabsf(A[i]) > 10.0f) inside = 0;
+    for (int i = 0; i < R * OUT; i++) if (fabsf(B[i]) > 10.0f) inside = 0;
+    ASSERT(inside, "batch clamps A and B to [-10, 10]");
+}
+
+// ── TEST 35s: layout descriptors ───────────────────────────────────────────
+
+static void test_delta_layout(void) {
+    printf("\n── delta layout descriptors ──\n");
+    enum { IN = 37, OUT = 2100, R = 8 };
+    static float A0[OUT * R], B0[R * IN], x[IN], dy[OUT];
+    static float Am[4][OUT * R], Bm[4][R * IN], out[4][OUT], ref[OUT];
+    AM_DeltaDesc d[4];
+
+    fill_logits(A0, OUT * R, 901u);
+    fill_logits(B0, R * IN, 902u);
+    fill_logits(x, IN, 903u);
+    fill_logits(dy, OUT, 904u);
+    for (int c = 0; c < 4; c++) {
+        int al = c & 1, bl = c >> 1;
+        for (int o = 0; o < OUT; o++)
+            for (int r = 0; r < R; r++)
+                Am[c][al ? r * OUT + o : o * R + r] = 0.2f * A0[o * R + r];
+        for (int r = 0; r < R; r++)
+            for (int i = 0; i < IN; i++)
+                Bm[c][bl ? i * R + r : r * IN + i] = 0.2f * B0[r * IN + i];
+        d[c] = (AM_DeltaDesc){ OUT, IN, R, Am[c], Bm[c], al, bl, NULL };
+    }
+
+    // ROW/ROW apply is am_apply_delta
+    memset(out, 0, sizeof(out));
+    memset(ref, 0, sizeof(ref));
+    am_apply_delta(ref, Am[0], Bm[0], x, OUT, IN, R, 0.6f);
+    am_delta_apply(out[0], &d[0], x, 0.6f);
+    ASSERT(!memcmp(out[0], ref, sizeof(ref)), "ROW/ROW apply == am_apply_delta");
+
+    // learn in place on every layout: identical matrices
+    for (int c = 0; c < 4; c++) {
+        am_init();
+        am_exec("NOTORCH_LR 0.05");
+        float rms = -1.0f;
+        for (int k = 0; k < 3; k++) am_delta_learn(&d[c], x, dy, k ? -0.5f : 1.0f, &rms);
+    }
+    int same = 1;
+    for (int c = 1; c < 4; c++) {
+        int al = c & 1, bl = c >> 1;
+        for (int o = 0; o < OUT; o++)
+            for (int r = 0; r < R; r++)
+                same &= Am[c][al ? r * OUT + o : o * R + r] == Am[0][o * R + r];
+        for (int r = 0; r < R; r++)
+            for (int i = 0; i < IN; i++)
+                same &= Bm[c][bl ? i * R + r : r * IN + i] == Bm[0][r * IN + i];
+    }
+    ASSERT(same, "learn gives the same factors in every layout");
+
+    // apply agrees across layouts
+    float err = 0.0f, mag = 0.0f;
+    for (int c = 0; c < 4; c++) {
+        memset(out[c], 0, sizeof(out[c]));
+        am_delta_apply(out[c], &d[c], x, 0.6f);
+    }
+    for (int c = 1; c < 4; c++)
+        for (int o = 0; o < OUT; o++) {
+            err = fmaxf(err, fabsf(out[c][o] - out[0][o]));
+            mag = fmaxf(mag, fabsf(out[0][o]));
+        }
+    ASSERT(mag > 0.0f && err <= 1e-5f * mag, "apply agrees across layouts");
+
+    // COL/COL is the NOTORCH layout: same as am_notorch_step_fused
+    memcpy(Am[1], Am[3], sizeof(Am[3]));
+    memcpy(Bm[1], Bm[3], sizeof(Bm[3]));
+    am_init();
+    am_exec("NOTORCH_LR 0.05");
+    float rms = -1.0f, rms2 = -1.0f;
+    for (int k = 0; k < 3; k++)
+        am_notorch_step_fused(Bm[1], Am[1], OUT, IN, R, x, dy, 0.7f, &rms, NULL);
+    am_init();
+    am_exec("NOTORCH_LR 0.05");
+    for (int k = 0; k < 3; k++) am_delta_learn(&d[3], x, dy, 0.7f, &rms2);
+    ASSERT(rms == rms2 && !memcmp(Am[1], Am[3], sizeof(Am[3])) &&
+           !memcmp(Bm[1], Bm[3], sizeof(Bm[3])), "COL/COL descriptor runs the NOTORCH step");
+
+    // NULL b_rms keeps no state: B rewritten in place is measured afresh
+    am_init();
+    am_exec("NOTORCH_DECAY 0.999");
+    for (int i = 0; i < R * IN; i++) Bm[0][i] = 9.0f;
+    am_delta_learn(&d[0], x, dy, 0.0f, NULL);
+    for (int i = 0; i < R * IN; i++) Bm[0][i] = 0.5f;
+    am_delta_learn(&d[0], x, dy, 0.0f, NULL);
+    ASSERT_FLOAT(Bm[0][3], 0.5f * 0.9988f, 1e-6f, "NULL b_rms measures B on every call");
+}
+
+// ── TEST 35t: counter-based streams ────────────────────────────────────────
+
+enum { TUNNEL_ROLLS = 256 };
+
+static void* tunnel_rolls(void* out) {
+    int* r = (int*)out;
+    for (int i = 0; i < TUNNEL_ROLLS; i++) r[i] = am_should_tunnel();
+    return NULL;
+}
+
+static void test_rng(void) {
+    printf("\n── counter-based RNG ──\n");
+    enum { N = 1000 };
+    static float a[N], b[N];
+    AM_Rng g, h;
+
+    // a fill equals the same number of single draws, split anywhere
+    am_rng_seed(&g, 7);
+    am_rng_fill(&g, a, N);
+    am_rng_seed(&h, 7);
+    am_rng_fill(&h, b, 333);
+    for (int i = 333; i < 700; i++) b[i] = am_rng_uniform(&h);
+    am_rng_fill(&h, b + 700, N - 700);
+    ASSERT(!memcmp(a, b, sizeof(a)) && g.ctr == N && h.ctr == N, "fill == single draws");
+
+    // every SIMD level draws the same bits
+    int best = am_simd_level(), same = 1;
+    for (int level = AM_SIMD_SCALAR; level <= best; level++) {
+        if (am_simd_set(level) != level) continue;
+        am_rng_seed(&h, 7);
+        am_rng_fill(&h, b, N);
+        same &= !memcmp(a, b, sizeof(a));
+    }
+    am_simd_set(best);
+    ASSERT(same, "rng identical at every SIMD level");
+
+    // uniform on [0, 1), and streams with different seeds differ
+    double mean = 0.0;
+    int range = 1;
+    for (int i = 0; i < N; i++) {
+        mean += a[i];
+        if (a[i] < 0.0f || a[i] >= 1.0f) range = 0;
+    }
+    ASSERT(range, "draws in [0, 1)");
+    ASSERT_FLOAT((float)(mean / N), 0.5f, 0.04f, "mean of 1000 draws ~ 0.5");
+    am_rng_seed(&h, 8);
+    am_rng_fill(&h, b, N);
+    ASSERT(memcmp(a, b, sizeof(a)) != 0, "other seed, other stream");
+
+    // the low counter word wrapping mid-fill changes nothing
+    am_rng_seed(&g, 9);
+    g.ctr = 0xFFFFFFF0ull;
+    h = g;
+    am_rng_fill(&g, a, 40);
+    for (int i = 0; i < 40; i++) b[i] = am_rng_uniform(&h);
+    ASSERT(!memcmp(a, b, 40 * sizeof(float)) && g.ctr == 0x100000018ull,
+           "fill across the 32-bit counter boundary");
+
+    // tunneling rolls come from the caller's stream
+    am_init();
+    AM_State* s = am_get_state();
+    s->dissonance = 1.0f;
+    s->tunnel_threshold = 0.5f;
+    s->tunnel_chance = 0.5f;
+    int r1[64], r2[64], hits = 0;
+    am_rng_seed(&g, 11);
+    for (int i = 0; i < 64; i++) hits += r1[i] = am_should_tunnel_rng(&g);
+    am_rng_seed(&g, 11);
+    for (int i = 0; i < 64; i++) r2[i] = am_should_tunnel_rng(&g);
+    ASSERT(!memcmp(r1, r2, sizeof(r1)) && hits > 8 && hits < 56,
+           "am_should_tunnel_rng deterministic per stream");
+
+    // am_should_tunnel rolls from the calling thread's stream: the same
+    // sequence on every thread, and again after am_init
+    static int t0[TUNNEL_ROLLS], t1[TUNNEL_ROLLS], t2[TUNNEL_ROLLS];
+    tunnel_rolls(t0);
+    am_init();
+    s->dissonance = 1.0f;
+    s->tunnel_threshold = 0.5f;
+    s->tunnel_chance = 0.5f;
+    tunnel_rolls(t1);
+    ASSERT(!memcmp(t0, t1, sizeof(t0)), "am_should_tunnel repeats after am_init");
+#ifdef TEST_THREADS
+    pthread_t th[2];
+    memset(t1, 0, sizeof(t1));
+    int started = pthread_create(&th[0], NULL, tunnel_rolls, t1) == 0;
+    started &= pthread_create(&th[1], NULL, tunnel_rolls, t2) == 0;
+    pthread_join(th[0], NULL);
+    pthread_join(th[1], NULL);
+    ASSERT(started && !memcmp(t0, t1, sizeof(t0)) && !memcmp(t0, t2, sizeof(t0)),
+           "each thread rolls the single-threaded sequence");
+#endif
+
+    s->dissonance = 0.1f;
+    ASSERT_INT(am_should_tunnel(), 0, "no tunnel below the dissonance gate");
+
+    // NOTORCH: a caller stream seeded 42 draws what the plain step draws
+    // after am_init, and adapters seeded apart draw other channels
+    enum { IN = 9, OUT = 7, R = 4 };
+    float A1[IN * R] = { 0 }, B1[R * OUT] = { 0 }, A2[IN * R] = { 0 }, B2[R * OUT] = { 0 };
+    float x[IN], dy[OUT], rms = -1.0f;
+    fill_logits(x, IN, 71u);
+    fill_logits(dy, OUT, 72u);
+    am_init();
+    am_exec("NOTORCH_LR 0.1");
+    am_notorch_step(A1, B1, OUT, IN, R, x, dy, 1.0f);
+    am_rng_seed(&g, 42);
+    am_notorch_step_fused(A2, B2, OUT, IN, R, x, dy, 1.0f, &rms, &g);
+    ASSERT(!memcmp(A1, A2, sizeof(A1)) && !memcmp(B1, B2, sizeof(B1)) && g.ctr == R,
+           "fused step draws from the caller's stream");
+
+    AM_Adapter p, q;
+    am_adapter_init(&p, OUT, IN, R, 1);
+    am_adapter_init(&q, OUT, IN, R, 2);
+    am_adapter_step(&p, x, dy, 1.0f);
+    am_adapter_step(&q, x, dy, 1.0f);
+    ASSERT(memcmp(p.B, q.B, (size_t)R * IN * sizeof(float)) != 0,
+           "adapters seeded apart draw different channels");
+    am_adapter_free(&p);
+    am_adapter_free(&q);
+}
+
+// ── TEST 35u: compiled scripts ─────────────────────────────────────────────
+
+static const char* g_vm_script =
+    "def bump(a, b):\n"
+    "    x = a * 2\n"
+    "    if x > b and not b == 0:\n"
+    "        TENSION x / 10\n"
+    "    else:\n"
+    "        TENSION 0.05\n"
+    "    DESTINY clamp(a + b, 0, 1)\n"
+    "\n"
+    "depth = 0\n"
+    "i = 0\n"
+    "while i < 7:\n"
+    "    i = i + 1\n"
+    "    depth = depth + max(i, 3) - min(i, 2) / 0\n"
+    "bump(0.3, 0.2)\n"
+    "bump(i, 0)\n"
+    "WORMHOLE sqrt(-0.25) + abs(-0.1)\n"
+    "PAIN (depth - 20) / 100\n"
+    "if undefined_name == 0 or false:\n"
+    "    echo_fractal(3)\n"
+    "galvanize()\n"
+    "v = 1+(2*(3-(4/(5+(6*(7-8))))))\n"
+    "ATTEND_FOCUS pain * 2 - v / 100\n"
+    "w = (1 + 2\n"
+    "PROPHECY_DEBT w + bump(1, 1) + 3 *\n"
+    "TUNNEL_CHANCE -tension + 0.5\n"
+    "CALENDAR_DRIFT 30 / -2 + prophecy\n";
+
+static void test_compile(void) {
+    printf("\n── compiled scripts ──\n");
+    float want[32], got[32];
+
+    am_init();
+    ASSERT_INT(am_exec(g_vm_script), 0, "am_exec reference run");
+    am_copy_state(want);
+    AM_State* s = am_get_state();
+    ASSERT_FLOAT(s->pain, 0.11f, 1e-6f, "loop + min/max + /0 → PAIN 0.11");
+    ASSERT_FLOAT(s->wormhole, 0.6f, 1e-6f, "sqrt(|x|) + abs → WORMHOLE 0.6");
+    ASSERT_FLOAT(s->attend_focus, 0.07f, 1e-6f, "nested parentheses");
+    ASSERT_FLOAT(s->tunnel_chance, 0.2f, 1e-6f, "unary minus on a field");
+    ASSERT_INT(s->prophecy, 12, "galvanize() after echo_fractal(3)");
+    ASSERT_INT(s->tunnel_skip_max, 3, "echo_fractal(3) ran: undefined name == 0");
+    ASSERT_FLOAT(s->debt, 0.0f, 0.0f, "parse errors evaluate to 0");
+
+    am_init();
+    AML_Program* p = am_compile(g_vm_script);
+    ASSERT(p != NULL, "am_compile");
+    ASSERT_INT(am_run(p), 0, "am_run");
+    am_copy_state(got);
+    ASSERT(!memcmp(want, got, sizeof(want)), "am_run state == am_exec state");
+
+    // a second run starts from empty variables, like a second am_exec
+    am_init();
+    am_run(p);
+    am_copy_state(got);
+    ASSERT(!memcmp(want, got, sizeof(want)), "re-run reproduces the state");
+    am_program_free(p);
+
+    p = am_compile("n = n + 1\nPROPHECY n + 3");
+    am_run(p);
+    am_run(p);
+    ASSERT_INT(am_get_state()->prophecy, 4, "variables reset between runs");
+    am_program_free(p);
+
+    // errors surface the same way
+    const char* deep = "def f():\n    f()\nf()";
+    am_exec(deep);
+    char msg[256];
+    snprintf(msg, sizeof(msg), "%s", am_get_error());
+    p = am_compile(deep);
+    ASSERT_INT(am_run(p), 1, "call depth error from am_run");
+    ASSERT(strcmp(msg, am_get_error()) == 0 && msg[0], "same error text as am_exec");
+    am_program_free(p);
+
+    p = am_compile("");
+    ASSERT(p != NULL && am_run(p) == 0, "empty program runs");
+    am_program_free(p);
+    ASSERT_INT(am_run(NULL), 2, "NULL program");
+}
+
+// ── TEST 35v: hashed Level 0 dispatch ──────────────────────────────────────
+
+static void test_cmd_dispatch(void) {
+    printf("\n── Level 0 command ids ──\n");
+    ASSERT_INT(am_cmd_id("PROPHECY"), AM_CMD_PROPHECY, "first command");
+    ASSERT_INT(am_cmd_id("BLOOD"), AM_CMD_BLOOD, "last command");
+    ASSERT_INT(am_cmd_id("presence_decay"), AM_CMD_PRESENCE_DECAY, "case-insensitive");
+    ASSERT_INT(am_cmd_id("IMPORT"), AM_CMD_MODE, "IMPORT aliases MODE");
+    ASSERT_INT(am_cmd_id("PROPHECY_DEBT_DECAY"), AM_CMD_PROPHECY_DEBT_DECAY, "prefix-sharing names");
+    ASSERT_INT(am_cmd_id("PROPHEC"), -1, "unknown name");
+    ASSERT_INT(am_cmd_id(NULL), -1, "NULL name");
+
+    am_init();
+    AM_State* s = am_get_state();
+    ASSERT_INT(am_exec_cmd(AM_CMD_PRESENCE_DECAY, "0.25"), 0, "am_exec_cmd");
+    ASSERT_FLOAT(s->presence_decay, 0.25f, 1e-6f, "PRESENCE_DECAY by id");
+    am_exec_cmd(AM_CMD_VELOCITY, "run");
+    ASSERT_INT(s->velocity_mode, AM_VEL_RUN, "VELOCITY RUN by id");
+    ASSERT_INT(am_exec_cmd(AM_CMD_COUNT, "1"), 1, "bad id rejected");
+
+    // pack commands: gated unqualified, auto-enabling when namespaced
+    am_exec("TEMPO 9");
+    ASSERT_INT(s->packs_enabled & AM_PACK_CODES_RIC, 0, "TEMPO without pack ignored");
+    am_exec("CODES.TEMPO 9");
+    ASSERT(s->packs_enabled & AM_PACK_CODES_RIC, "CODES.TEMPO enables pack");
+    ASSERT_INT(s->tempo, 9, "CODES.TEMPO 9");
+    am_exec("DISABLE CODES_RIC\nPAIN 0.1\nRIC.PAIN 0.9");
+    ASSERT(s->packs_enabled & AM_PACK_CODES_RIC, "RIC.* enables pack");
+    ASSERT_FLOAT(s->pain, 0.1f, 1e-6f, "RIC.PAIN is not a pack command");
+
+    // commands at the bottom of the table, and compiled dispatch
+    AML_Program* p = am_compile("MACRO calm { PAIN 0.05; TENSION 0.05 }\nPAIN 0.8\n@calm\nRIC.TEMPOLOCK on");
+    am_init();
+    am_run(p);
+    ASSERT_FLOAT(s->pain, 0.05f, 1e-6f, "MACRO + @call through am_run");
+    ASSERT_INT(s->tempolock_on, 1, "namespaced command through am_run");
+    am_program_free(p);
+}
+
+// ── TEST 35w: field ids ────────────────────────────────────────────────────
+
+static void test_field_ids(void) {
+    printf("\n── field ids ──\n");
+    am_init();
+    AM_State* s = am_get_state();
+    s->pain = 0.6f;
+    s->prophecy = 11;
+    int pain = am_field_id("PAIN");
+    ASSERT(pain >= 0 && am_field_id("pain") == pain, "field id, case-insensitive");
+    ASSERT_FLOAT(am_get_field_by_id(pain), 0.6f, 1e-6f, "float field by id");
+    ASSERT_FLOAT(am_get_field_by_id(am_field_id("prophecy")), 11.0f, 1e-6f, "int field by id");
+    ASSERT_INT(am_field_id("no_such_field"), -1, "unknown field");
+    ASSERT_INT(am_field_id(NULL), -1, "NULL field name");
+    ASSERT_FLOAT(am_get_field_by_id(-1), 0.0f, 0.0f, "bad id reads 0");
+    s->dark_gravity = 0.4f;
+    ASSERT_FLOAT(am_get_field_by_id(am_field_id("DARK_GRAVITY")), 0.4f, 1e-6f, "dark_gravity");
+    ASSERT(am_field_id("wormhole_tokens") != am_field_id("wormhole"), "distinct ids");
+
+    // script variables still shadow fields; unassigned names read the field
+    const char* src =
+        "def f(tension):\n"
+        "    if tension > 0.5 and pain > 0.5:\n"
+        "        DESTINY 0.9\n"
+        "f(0.7)\n"
+        "if pain > 0.5 and TENSION < 0.3:\n"
+        "    PROPHECY 9\n"
+        "pain = 0.1\n"
+        "if pain < 0.5:\n"
+        "    ATTEND_FOCUS 0.2\n";
+    float want[32], got[32];
+    am_init();
+    am_get_state()->pain = 0.6f;
+    am_exec(src);
+    am_copy_state(want);
+    ASSERT_INT(am_get_state()->prophecy, 9, "field read in a condition");
+    ASSERT_FLOAT(am_get_state()->destiny, 0.9f, 1e-6f, "parameter shadows field");
+    ASSERT_FLOAT(am_get_state()->attend_focus, 0.2f, 1e-6f, "global shadows field");
+    AML_Program* p = am_compile(src);
+    am_init();
+    am_get_state()->pain = 0.6f;
+    am_run(p);
+    am_copy_state(got);
+    ASSERT(!memcmp(want, got, sizeof(want)), "am_run resolves names like am_exec");
+    am_program_free(p);
+}
+
+// ── TEST 35x: loops over compiled conditions ──────────────────────────────
+
+static void test_compiled_loops(void) {
+    printf("\n── compiled loops ──\n");
+    am_init();
+    am_exec("PAIN 0.5\n"
+            "while pain > 0.1:\n"
+            "    PAIN pain - 0.07\n"
+            "    PROPHECY prophecy + 1\n");
+    ASSERT_INT(am_get_state()->prophecy, 13, "Level 0 expression args re-evaluated per iteration");
+    ASSERT_FLOAT(am_get_state()->pain, 0.08f, 1e-5f, "loop exits on the field condition");
+
+    am_exec("i = 0\n"
+            "while 1:\n"
+            "    i = i + 1\n"
+            "PROPHECY i / 1000\n");
+    ASSERT_INT(am_get_state()->prophecy, 10, "while stops at 10000 iterations");
+
+    am_exec("n = 0\n"
+            "j = 0\n"
+            "while j < 3:\n"
+            "    k = 0\n"
+            "    while k < 4:\n"
+            "        n = n + 1\n"
+            "        k = k + 1\n"
+            "    j = j + 1\n"
+            "PROPHECY n\n");
+    ASSERT_INT(am_get_state()->prophecy, 12, "nested loops");
+}
+
+// ── TEST 35y: slot-resolved variables ─────────────────────────────────────
+
+static void test_var_slots(void) {
+    printf("\n── variable slots ──\n");
+    static char src[4096];
+    int n = snprintf(src, sizeof(src), "v0 = 0\n");
+    for (int i = 1; i < 100; i++)
+        n += snprintf(src + n, sizeof(src) - n, "v%d = v%d + 1\n", i, i - 1);
+    snprintf(src + n, sizeof(src) - n, "PROPHECY v99 - 50\n");
+    am_init();
+    am_exec(src);
+    ASSERT_INT(am_get_state()->prophecy, 49, "100 globals, no 64-variable cap");
+
+    // every call depth has its own frame
+    am_init();
+    am_exec("def f(n):\n"
+            "    if n > 0:\n"
+            "        x = n\n"
+            "        f(n - 1)\n"
+            "        PROPHECY prophecy + x\n"
+            "f(5)\n");
+    ASSERT_INT(am_get_state()->prophecy, 22, "recursive locals kept per frame");
+
+    // locals shadow globals only once assigned, and never leak out
+    am_exec("g = 3\n"
+            "def h():\n"
+            "    PAIN g / 10\n"
+            "    g = 0.5\n"
+            "    TENSION g\n"
+            "h()\n"
+            "DESTINY g / 10\n");
+    AM_State* s = am_get_state();
+    ASSERT_FLOAT(s->pain, 0.3f, 1e-6f, "global read before the local exists");
+    ASSERT_FLOAT(s->tension, 0.5f, 1e-6f, "local after assignment");
+    ASSERT_FLOAT(s->destiny, 0.3f, 1e-6f, "global untouched by the local");
+
+    // text-valued arguments resolve names through the same slots
+    am_exec("def f(a):\n"
+            "    LAW ENTROPY_FLOOR a * 2\n"
+            "f(0.4)\n");
+    ASSERT_FLOAT(s->entropy_floor, 0.8f, 1e-6f, "LAW value reads a parameter");
+}
+
 // ── TEST 36: COSMIC_COHERENCE backward compat ─────────────────────────────
 
 static void test_cosmic_coherence_compat(void) {
@@ -957,6 +2432,30 @@ int main(void) {
     test_field_map();
     test_logit_attention();
     test_logit_laws();
+    test_logit_fused();
+    test_logit_simd();
+    test_logit_batch();
+    test_logit_threads();
+    test_logit_half();
+    test_logit_candidates();
+    test_field_plan();
+    test_sample_field();
+    test_commit_token();
+    test_delta_kernels();
+    test_delta_batch();
+    test_delta_stack();
+    test_qmatrix();
+    test_notorch_fused();
+    test_adapter();
+    test_learner();
+    test_notorch_batch();
+    test_delta_layout();
+    test_rng();
+    test_compile();
+    test_cmd_dispatch();
+    test_field_ids();
+    test_compiled_loops();
+    test_var_slots();
     test_cosmic_coherence_compat();
     test_copy_state_32();
 